@@ -0,0 +1,101 @@
+//===- number_format.cpp ----------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2019 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+//
+// Compares the integer formatting of the printers with the stream formatting
+// it replaces: addresses in hexadecimal and immediates in decimal, written to
+// a string stream.
+//
+// usage: number_format [COUNT]
+//
+//===----------------------------------------------------------------------===//
+#include "NumberFormat.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Print the time per number, in nanoseconds, of writing every value to a
+// string stream.
+void report(const std::string& name, size_t count,
+            const std::function<void(std::ostream&)>& run) {
+  std::ostringstream os;
+  Clock::time_point start = Clock::now();
+  run(os);
+  double ns =
+      std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+  std::cout << std::left << std::setw(32) << name << std::right << std::fixed
+            << std::setprecision(2) << std::setw(12) << ns / count
+            << std::setw(12) << os.tellp() << '\n';
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  if (argc > 2) {
+    std::cerr << "usage: " << argv[0] << " [COUNT]\n";
+    return EXIT_FAILURE;
+  }
+  size_t count = argc == 2 ? std::stoul(argv[1]) : 10000000;
+  if (count == 0) {
+    std::cerr << "COUNT must be positive\n";
+    return EXIT_FAILURE;
+  }
+
+  // Addresses of a typical executable, and immediates that are mostly small.
+  std::mt19937_64 random(0);
+  std::vector<uint64_t> addresses(count);
+  std::vector<int64_t> immediates(count);
+  for (size_t i = 0; i < count; ++i) {
+    addresses[i] = 0x400000 + random() % 0x1000000;
+    immediates[i] = static_cast<int64_t>(random() % 4096) - 64;
+  }
+
+  std::cout << count << " numbers, times in nanoseconds per number\n"
+            << std::left << std::setw(32) << "" << std::right << std::setw(12)
+            << "time" << std::setw(12) << "bytes" << '\n';
+
+  report("hexadecimal, iostream", count, [&](std::ostream& os) {
+    for (uint64_t address : addresses)
+      os << std::hex << address << std::dec << '\n';
+  });
+  report("hexadecimal, number_format", count, [&](std::ostream& os) {
+    for (uint64_t address : addresses) {
+      gtirb_pprint::number_format::writeHex(os, address);
+      os << '\n';
+    }
+  });
+  report("decimal, iostream", count, [&](std::ostream& os) {
+    for (int64_t immediate : immediates)
+      os << immediate << '\n';
+  });
+  report("decimal, number_format", count, [&](std::ostream& os) {
+    for (int64_t immediate : immediates) {
+      gtirb_pprint::number_format::writeDecimal(os, immediate);
+      os << '\n';
+    }
+  });
+  return EXIT_SUCCESS;
+}
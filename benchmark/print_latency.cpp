@@ -0,0 +1,125 @@
+//===- print_latency.cpp ----------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2019 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+//
+// Measures the latency of printing the modules of an IR one call at a time:
+// the time from the call to the first chunk of assembly, and to the complete
+// assembly, for a prepared module and for a module prepared by the call.
+//
+// usage: print_latency IR [ITERATIONS]
+//
+//===----------------------------------------------------------------------===//
+#include "ChunkGenerator.hpp"
+#include "PrettyPrinter.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Run a measurement the given number of times and print the median and the
+// mean time, in microseconds.
+void report(const std::string& name, size_t iterations,
+            const std::function<void()>& run) {
+  std::vector<double> times;
+  times.reserve(iterations);
+  for (size_t i = 0; i < iterations; ++i) {
+    Clock::time_point start = Clock::now();
+    run();
+    times.push_back(
+        std::chrono::duration<double, std::micro>(Clock::now() - start)
+            .count());
+  }
+  double mean = 0;
+  for (double t : times)
+    mean += t / times.size();
+  std::nth_element(times.begin(), times.begin() + times.size() / 2,
+                   times.end());
+  std::cout << std::left << std::setw(32) << name << std::right
+            << std::fixed << std::setprecision(1) << std::setw(12)
+            << times[times.size() / 2] << std::setw(12) << mean << '\n';
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2 || argc > 3) {
+    std::cerr << "usage: " << argv[0] << " IR [ITERATIONS]\n";
+    return EXIT_FAILURE;
+  }
+  size_t iterations = argc == 3 ? std::stoul(argv[2]) : 1000;
+  if (iterations == 0) {
+    std::cerr << "ITERATIONS must be positive\n";
+    return EXIT_FAILURE;
+  }
+
+  gtirb::Context ctx;
+  std::ifstream in(argv[1], std::ios::in | std::ios::binary);
+  gtirb::IR* ir = gtirb::IR::load(ctx, in);
+  if (!ir || ir->modules().empty()) {
+    std::cerr << "could not load " << argv[1] << '\n';
+    return EXIT_FAILURE;
+  }
+  std::vector<gtirb::Module*> modules;
+  std::vector<std::unique_ptr<gtirb_pprint::PreparedModule>> prepared;
+  for (gtirb::Module& m : ir->modules()) {
+    modules.push_back(&m);
+    prepared.push_back(std::make_unique<gtirb_pprint::PreparedModule>(ctx, m));
+  }
+
+  gtirb_pprint::PrettyPrinter pp;
+  std::cout << modules.size() << " modules, " << iterations
+            << " iterations, times in microseconds per module\n"
+            << std::left << std::setw(32) << "" << std::right << std::setw(12)
+            << "median" << std::setw(12) << "mean" << '\n';
+
+  size_t next = 0;
+  auto nextIndex = [&]() { return next++ % modules.size(); };
+
+  report("open capstone handle", iterations, [&]() {
+    csh handle;
+    cs_open(CS_ARCH_X86, CS_MODE_64, &handle);
+    cs_option(handle, CS_OPT_DETAIL, CS_OPT_ON);
+    cs_close(&handle);
+  });
+  report("first chunk, prepared", iterations, [&]() {
+    gtirb_pprint::ChunkGenerator chunks = pp.generate(*prepared[nextIndex()]);
+    chunks.next();
+  });
+  report("first chunk, unprepared", iterations, [&]() {
+    gtirb_pprint::ChunkGenerator chunks =
+        pp.generate(ctx, *modules[nextIndex()]);
+    chunks.next();
+  });
+  report("whole module, prepared", iterations, [&]() {
+    std::ostringstream os;
+    pp.print(os, *prepared[nextIndex()]);
+  });
+  report("whole module, unprepared", iterations, [&]() {
+    std::ostringstream os;
+    pp.print(os, ctx, *modules[nextIndex()]);
+  });
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,136 @@
+//===- printer_dispatch.cpp -------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2019 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+//
+// Compares the time it takes to print the modules of an IR with the built-in
+// ELF printers, whose operands are printed without virtual calls, and with
+// the same printers called virtually, as a printer derived from them would.
+//
+// usage: printer_dispatch IR [ITERATIONS]
+//
+// Fails if a static printer is slower than the virtual one by more than 5%.
+//
+//===----------------------------------------------------------------------===//
+#include "AttPrettyPrinter.hpp"
+#include "IntelPrettyPrinter.hpp"
+#include "StaticPrettyPrinter.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Discards everything written to it, so that only the printing is measured.
+class NullBuffer : public std::streambuf {
+protected:
+  int overflow(int c) override { return c; }
+  std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+// Print every module the given number of times with a new printer each time,
+// and print the median and the mean time per module, in microseconds. Return
+// the median.
+template <class Printer, class Syntax>
+double report(const std::string& name, size_t iterations,
+            const std::vector<std::unique_ptr<gtirb_pprint::PreparedModule>>&
+                modules) {
+  static const Syntax syntax{};
+  const gtirb_pprint::PrintingPolicy& policy =
+      gtirb_pprint::ElfPrettyPrinter::defaultPrintingPolicy();
+  NullBuffer buffer;
+  std::ostream os(&buffer);
+  std::vector<double> times;
+  times.reserve(iterations * modules.size());
+  for (size_t i = 0; i < iterations; ++i) {
+    for (const auto& prepared : modules) {
+      Clock::time_point start = Clock::now();
+      Printer(*prepared, syntax, policy).print(os);
+      times.push_back(
+          std::chrono::duration<double, std::micro>(Clock::now() - start)
+              .count());
+    }
+  }
+  double mean = 0;
+  for (double t : times)
+    mean += t / times.size();
+  std::nth_element(times.begin(), times.begin() + times.size() / 2,
+                   times.end());
+  std::cout << std::left << std::setw(32) << name << std::right
+            << std::fixed << std::setprecision(1) << std::setw(12)
+            << times[times.size() / 2] << std::setw(12) << mean << '\n';
+  return times[times.size() / 2];
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2 || argc > 3) {
+    std::cerr << "usage: " << argv[0] << " IR [ITERATIONS]\n";
+    return EXIT_FAILURE;
+  }
+  size_t iterations = argc == 3 ? std::stoul(argv[2]) : 100;
+  if (iterations == 0) {
+    std::cerr << "ITERATIONS must be positive\n";
+    return EXIT_FAILURE;
+  }
+
+  gtirb::Context ctx;
+  std::ifstream in(argv[1], std::ios::in | std::ios::binary);
+  gtirb::IR* ir = gtirb::IR::load(ctx, in);
+  if (!ir || ir->modules().empty()) {
+    std::cerr << "could not load " << argv[1] << '\n';
+    return EXIT_FAILURE;
+  }
+  std::vector<std::unique_ptr<gtirb_pprint::PreparedModule>> modules;
+  for (gtirb::Module& m : ir->modules())
+    modules.push_back(std::make_unique<gtirb_pprint::PreparedModule>(ctx, m));
+
+  using gtirb_pprint::AttPrettyPrinter;
+  using gtirb_pprint::ElfSyntax;
+  using gtirb_pprint::IntelPrettyPrinter;
+  using gtirb_pprint::IntelSyntax;
+  using gtirb_pprint::StaticPrettyPrinter;
+
+  std::cout << modules.size() << " modules, " << iterations
+            << " iterations, times in microseconds per module\n"
+            << std::left << std::setw(32) << "" << std::right << std::setw(12)
+            << "median" << std::setw(12) << "mean" << '\n';
+  double attVirtual =
+      report<AttPrettyPrinter, ElfSyntax>("att, virtual", iterations, modules);
+  double attStatic = report<StaticPrettyPrinter<AttPrettyPrinter>, ElfSyntax>(
+      "att, static", iterations, modules);
+  double intelVirtual = report<IntelPrettyPrinter, IntelSyntax>(
+      "intel, virtual", iterations, modules);
+  double intelStatic =
+      report<StaticPrettyPrinter<IntelPrettyPrinter>, IntelSyntax>(
+          "intel, static", iterations, modules);
+  std::cout << std::setprecision(3) << "speedup: att "
+            << attVirtual / attStatic << ", intel "
+            << intelVirtual / intelStatic << '\n';
+  if (attStatic > attVirtual * 1.05 || intelStatic > intelVirtual * 1.05) {
+    std::cerr << "the static printers are slower than the virtual ones\n";
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
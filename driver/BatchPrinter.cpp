@@ -0,0 +1,261 @@
+#include "BatchPrinter.hpp"
+#include "Logger.h"
+#include "PrettyPrinter.hpp"
+#include "Trace.hpp"
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wshadow"
+#endif // __GNUC__
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif // __GNUC__
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+
+fs::path getAsmFileName(const fs::path& InitialPath, int Index) {
+  if (Index == 0)
+    return InitialPath;
+  std::string Filename = InitialPath.filename().generic_string();
+  // If the name does not have an extension, we add the number at the end.
+  size_t LastDot = Filename.rfind('.');
+  if (LastDot == std::string::npos)
+    Filename.append(std::to_string(Index));
+  // Otherwise, we add the number before the extension.
+  else
+    Filename.insert(LastDot, std::to_string(Index));
+  return fs::path(InitialPath).replace_filename(Filename);
+}
+
+void configurePrinter(gtirb_pprint::PrettyPrinter& pp,
+                      const BatchOptions& options,
+                      const gtirb::Module& module) {
+  pp.setDebug(options.debug);
+  pp.setCompact(options.compact);
+  pp.setTarget(
+      gtirb_pprint::resolveTarget(module, options.format, options.syntax));
+  for (const auto& keep : options.keepFunctions)
+    pp.keepFunction(keep);
+  for (const auto& skip : options.skipFunctions)
+    pp.skipFunction(skip);
+}
+
+std::optional<OutputSpec> parseOutputSpec(const std::string& spec,
+                                          const BatchOptions& defaults) {
+  // The path may contain colons, so it is whatever follows the third one.
+  size_t formatEnd = spec.find(':');
+  if (formatEnd == std::string::npos)
+    return std::nullopt;
+  size_t syntaxEnd = spec.find(':', formatEnd + 1);
+  if (syntaxEnd == std::string::npos)
+    return std::nullopt;
+  size_t flagsEnd = spec.find(':', syntaxEnd + 1);
+  if (flagsEnd == std::string::npos || flagsEnd + 1 == spec.size())
+    return std::nullopt;
+
+  OutputSpec output{defaults, spec.substr(flagsEnd + 1)};
+  std::string format = spec.substr(0, formatEnd);
+  std::string syntax = spec.substr(formatEnd + 1, syntaxEnd - formatEnd - 1);
+  if (!format.empty())
+    output.options.format = format;
+  if (!syntax.empty())
+    output.options.syntax = syntax;
+  std::istringstream flags(
+      spec.substr(syntaxEnd + 1, flagsEnd - syntaxEnd - 1));
+  for (std::string flag; std::getline(flags, flag, ',');) {
+    if (flag.empty())
+      continue;
+    if (flag == "debug")
+      output.options.debug = true;
+    else if (flag == "compact")
+      output.options.compact = true;
+    else if (flag.rfind("skip=", 0) == 0 && flag.size() > 5)
+      output.options.skipFunctions.push_back(flag.substr(5));
+    else if (flag.rfind("keep=", 0) == 0 && flag.size() > 5)
+      output.options.keepFunctions.push_back(flag.substr(5));
+    else
+      return std::nullopt;
+  }
+  return output;
+}
+
+namespace {
+
+struct BatchTask {
+  std::string input;
+  std::string output;
+};
+
+struct BatchResult {
+  bool success = false;
+  std::string message;
+  double seconds = 0;
+};
+
+bool readBatchFile(const std::string& listPath, std::vector<BatchTask>& tasks) {
+  std::ifstream in(listPath);
+  if (!in) {
+    LOG_ERROR << "Could not open batch file: " << listPath << std::endl;
+    return false;
+  }
+  int lineNumber = 0;
+  for (std::string line; std::getline(in, line);) {
+    ++lineNumber;
+    std::istringstream fields(line);
+    BatchTask task;
+    if (!(fields >> task.input) || task.input[0] == '#')
+      continue;
+    std::string extra;
+    if (!(fields >> task.output) || (fields >> extra)) {
+      LOG_ERROR << listPath << ":" << lineNumber
+                << ": expected an input IR and an output file" << std::endl;
+      return false;
+    }
+    tasks.push_back(std::move(task));
+  }
+  return true;
+}
+
+// Load and print one IR. The context, and with it the IR, is released when
+// the function returns.
+void printTask(const BatchTask& task, const BatchOptions& options,
+               BatchResult& result) {
+  if (!fs::exists(task.input))
+    throw std::runtime_error("IR not found");
+  gtirb::Context ctx;
+  std::ifstream in(task.input, std::ios::in | std::ios::binary);
+  gtirb::IR* ir;
+  {
+    gtirb_pprint::trace::Span span("io", "load IR", task.input);
+    ir = gtirb::IR::load(ctx, in);
+  }
+  if (!ir)
+    throw std::runtime_error("could not load IR");
+  if (ir->modules().empty())
+    throw std::runtime_error("IR has no modules");
+
+  gtirb_pprint::PrettyPrinter pp;
+  configurePrinter(pp, options, *ir->modules().begin());
+
+  int i = 0;
+  for (gtirb::Module& m : ir->modules()) {
+    fs::path name = getAsmFileName(task.output, i++);
+    gtirb_pprint::trace::Span span("print", "print file", name.string());
+    std::ofstream ofs(name);
+    if (!ofs)
+      throw std::runtime_error("could not open output file " + name.string());
+    pp.print(ofs, ctx, m);
+  }
+  result.message = std::to_string(i) + (i == 1 ? " module" : " modules");
+}
+
+} // namespace
+
+int printOutputs(gtirb::Context& context, gtirb::IR& ir,
+                 const std::vector<OutputSpec>& outputs, std::size_t jobs) {
+  std::vector<std::unique_ptr<gtirb_pprint::PreparedModule>> modules;
+  for (gtirb::Module& m : ir.modules())
+    modules.push_back(
+        std::make_unique<gtirb_pprint::PreparedModule>(context, m));
+
+  struct OutputTask {
+    const OutputSpec* output;
+    const gtirb_pprint::PreparedModule* module;
+    fs::path path;
+    BatchResult result;
+  };
+  std::vector<OutputTask> tasks;
+  for (const OutputSpec& output : outputs)
+    for (int i = 0; i < static_cast<int>(modules.size()); ++i)
+      tasks.push_back(OutputTask{&output, modules[i].get(),
+                                 getAsmFileName(output.path, i),
+                                 BatchResult{}});
+
+  {
+    boost::asio::thread_pool pool(
+        std::max<std::size_t>(std::min(jobs, tasks.size()), 1));
+    for (OutputTask& task : tasks) {
+      boost::asio::post(pool, [&task]() {
+        try {
+          gtirb_pprint::trace::Span span("print", "print output",
+                                         task.path.string());
+          gtirb_pprint::PrettyPrinter pp;
+          configurePrinter(pp, task.output->options,
+                           task.module->getModule());
+          std::ofstream ofs(task.path);
+          if (!ofs)
+            throw std::runtime_error("could not open output file");
+          pp.print(ofs, *task.module);
+          task.result.success = true;
+        } catch (const std::exception& e) {
+          task.result.message = e.what();
+        }
+      });
+    }
+    pool.join();
+  }
+
+  std::size_t failures = 0;
+  for (const OutputTask& task : tasks) {
+    if (task.result.success) {
+      LOG_INFO << "Assembly written to: " << task.path << std::endl;
+    } else {
+      LOG_ERROR << "Could not print " << task.path << ": "
+                << task.result.message << std::endl;
+      ++failures;
+    }
+  }
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int runBatch(const std::string& listPath, std::size_t jobs,
+             const BatchOptions& options) {
+  std::vector<BatchTask> tasks;
+  if (!readBatchFile(listPath, tasks))
+    return EXIT_FAILURE;
+
+  using Clock = std::chrono::steady_clock;
+  auto start = Clock::now();
+  std::vector<BatchResult> results(tasks.size());
+  {
+    boost::asio::thread_pool pool(
+        std::max<std::size_t>(std::min(jobs, tasks.size()), 1));
+    for (std::size_t i = 0; i < tasks.size(); ++i) {
+      boost::asio::post(pool, [&task = tasks[i], &result = results[i],
+                               &options]() {
+        auto taskStart = Clock::now();
+        try {
+          printTask(task, options, result);
+          result.success = true;
+        } catch (const std::exception& e) {
+          result.message = e.what();
+        }
+        result.seconds =
+            std::chrono::duration<double>(Clock::now() - taskStart).count();
+      });
+    }
+    pool.join();
+  }
+  double total = std::chrono::duration<double>(Clock::now() - start).count();
+
+  std::size_t failures = 0;
+  for (std::size_t i = 0; i < tasks.size(); ++i) {
+    const BatchResult& result = results[i];
+    LOG_INFO << std::setw(5) << std::left << (result.success ? "OK" : "FAIL")
+             << std::setw(10) << std::right << std::fixed
+             << std::setprecision(3) << result.seconds << "s  "
+             << tasks[i].input << " -> " << tasks[i].output << " ("
+             << result.message << ")" << std::endl;
+    if (!result.success)
+      ++failures;
+  }
+  LOG_INFO << tasks.size() - failures << " of " << tasks.size()
+           << " files printed in " << std::fixed << std::setprecision(3)
+           << total << "s" << std::endl;
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+#ifdef USE_STD_FILESYSTEM_LIB
+#include <filesystem>
+namespace fs = std::filesystem;
+#else
+#include <experimental/filesystem>
+namespace fs = std::experimental::filesystem;
+#endif // USE_STD_FILESYSTEM_LIB
+
+namespace gtirb {
+class Context;
+class IR;
+class Module;
+} // namespace gtirb
+
+namespace gtirb_pprint {
+class PrettyPrinter;
+} // namespace gtirb_pprint
+
+/// The name of the assembly file of the module with the given index: the first
+/// module is printed to \p InitialPath and the others get their index added
+/// before the extension.
+fs::path getAsmFileName(const fs::path& InitialPath, int Index);
+
+/// Printing options shared by all the files of a batch.
+struct BatchOptions {
+  std::string format; ///< Empty to use each module's file format.
+  std::string syntax; ///< Empty to use the format's default syntax.
+  bool debug = false;
+  bool compact = false;
+  std::vector<std::string> keepFunctions;
+  std::vector<std::string> skipFunctions;
+};
+
+/// Configure a printer for a module. Throws std::invalid_argument if the format
+/// and syntax are not supported.
+void configurePrinter(gtirb_pprint::PrettyPrinter& pp,
+                      const BatchOptions& options, const gtirb::Module& module);
+
+/// An assembly file to print from an IR, and how to print it.
+struct OutputSpec {
+  BatchOptions options;
+  std::string path;
+};
+
+/// Parse an output specification of the form FORMAT:SYNTAX:FLAGS:PATH.
+/// Empty fields keep the value of \p defaults. FLAGS is a comma-separated
+/// list of "debug", "compact", "skip=FUNCTION" and "keep=FUNCTION", which
+/// are added to those of \p defaults.
+///
+/// \return the output, or nothing if the specification is malformed.
+std::optional<OutputSpec> parseOutputSpec(const std::string& spec,
+                                          const BatchOptions& defaults);
+
+/// Print every module of an IR to every output. Each module is prepared once
+/// for all the outputs, and the outputs are printed concurrently by \p jobs
+/// workers. IRs with several modules are written like with --asm.
+///
+/// \return EXIT_SUCCESS if every output was printed, EXIT_FAILURE otherwise.
+int printOutputs(gtirb::Context& context, gtirb::IR& ir,
+                 const std::vector<OutputSpec>& outputs, std::size_t jobs);
+
+/// Print every IR named in a batch file.
+///
+/// Each non-empty line of the batch file that does not start with '#' names
+/// an input IR and the assembly file to write, separated by whitespace. IRs
+/// with several modules are written like with --asm. Files are printed
+/// concurrently by \p jobs workers, each with its own gtirb::Context that is
+/// released as soon as the file is done, and a summary with the outcome and
+/// the time taken for each file is printed at the end.
+///
+/// \return EXIT_SUCCESS if every file was printed, EXIT_FAILURE otherwise.
+int runBatch(const std::string& listPath, std::size_t jobs,
+             const BatchOptions& options);
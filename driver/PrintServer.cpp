@@ -0,0 +1,338 @@
+#include "PrintServer.hpp"
+#include "Logger.h"
+#include "PrettyPrinter.hpp"
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wshadow"
+#endif // __GNUC__
+#include <boost/asio.hpp>
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif // __GNUC__
+#include <algorithm>
+#include <csignal>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#ifdef USE_STD_FILESYSTEM_LIB
+#include <filesystem>
+namespace fs = std::filesystem;
+#else
+#include <experimental/filesystem>
+namespace fs = std::experimental::filesystem;
+#endif // USE_STD_FILESYSTEM_LIB
+
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+
+namespace asio = boost::asio;
+using stream_protocol = asio::local::stream_protocol;
+
+namespace {
+
+/// An IR loaded by the server, together with the context that owns it and
+/// the prepared modules shared by all the requests printing it.
+struct LoadedIR {
+  gtirb::Context context;
+  gtirb::IR* ir = nullptr;
+  std::vector<std::unique_ptr<gtirb_pprint::PreparedModule>> modules;
+};
+
+/// LRU cache of loaded IRs, keyed by file path and modification time. An IR is
+/// loaded only once even if several requests ask for it concurrently, and
+/// evicted IRs stay alive until the requests using them are done.
+class IRCache {
+public:
+  explicit IRCache(std::size_t capacity_) : capacity(capacity_) {}
+
+  std::shared_ptr<LoadedIR> get(const std::string& path) {
+    if (!fs::exists(path))
+      throw std::runtime_error("IR not found: " + path);
+    std::string key =
+        path + '@' +
+        std::to_string(fs::last_write_time(path).time_since_epoch().count());
+
+    std::promise<std::shared_ptr<LoadedIR>> promise;
+    Entry entry;
+    bool load = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto found = entries.find(key);
+      if (found != entries.end()) {
+        order.splice(order.begin(), order, found->second.second);
+        entry = found->second.first;
+      } else {
+        entry = promise.get_future().share();
+        order.push_front(key);
+        entries.emplace(key, std::make_pair(entry, order.begin()));
+        load = true;
+        while (entries.size() > capacity) {
+          entries.erase(order.back());
+          order.pop_back();
+        }
+      }
+    }
+
+    if (load) {
+      try {
+        LOG_INFO << "Reading IR: " << path << std::endl;
+        auto loaded = std::make_shared<LoadedIR>();
+        std::ifstream in(path, std::ios::in | std::ios::binary);
+        loaded->ir = gtirb::IR::load(loaded->context, in);
+        if (!loaded->ir)
+          throw std::runtime_error("could not load IR: " + path);
+        for (gtirb::Module& m : loaded->ir->modules())
+          loaded->modules.push_back(
+              std::make_unique<gtirb_pprint::PreparedModule>(loaded->context,
+                                                             m));
+        promise.set_value(loaded);
+      } catch (...) {
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          auto found = entries.find(key);
+          if (found != entries.end()) {
+            order.erase(found->second.second);
+            entries.erase(found);
+          }
+        }
+        promise.set_exception(std::current_exception());
+      }
+    }
+    return entry.get();
+  }
+
+private:
+  using Entry = std::shared_future<std::shared_ptr<LoadedIR>>;
+
+  std::size_t capacity;
+  std::mutex mutex;
+  // Keys ordered from the most to the least recently used.
+  std::list<std::string> order;
+  std::map<std::string, std::pair<Entry, std::list<std::string>::iterator>>
+      entries;
+};
+
+struct Request {
+  std::string ir;
+  int module = 0;
+  std::string format;
+  std::string syntax;
+  bool debug = false;
+  bool compact = false;
+  std::vector<std::string> skipFunctions;
+  std::vector<std::string> keepFunctions;
+};
+
+Request parseRequest(std::istream& in) {
+  // Consume the whole request before interpreting it, so that a malformed
+  // request does not leave lines behind for the next one.
+  std::vector<std::string> lines;
+  for (std::string next; std::getline(in, next) && !next.empty();)
+    lines.push_back(next);
+
+  Request request;
+  for (const std::string& line : lines) {
+    size_t sep = line.find('=');
+    if (sep == std::string::npos)
+      throw std::runtime_error("malformed request line: " + line);
+    std::string key = line.substr(0, sep);
+    std::string value = line.substr(sep + 1);
+    if (key == "ir")
+      request.ir = value;
+    else if (key == "module")
+      request.module = std::stoi(value);
+    else if (key == "format")
+      request.format = value;
+    else if (key == "syntax")
+      request.syntax = value;
+    else if (key == "debug")
+      request.debug = value == "1";
+    else if (key == "compact")
+      request.compact = value == "1";
+    else if (key == "skip-function")
+      request.skipFunctions.push_back(value);
+    else if (key == "keep-function")
+      request.keepFunctions.push_back(value);
+    else
+      throw std::runtime_error("unknown request key: " + key);
+  }
+  return request;
+}
+
+std::string serve(const Request& request, IRCache& cache) {
+  if (request.ir.empty())
+    throw std::runtime_error("no IR given");
+  std::shared_ptr<LoadedIR> loaded = cache.get(request.ir);
+
+  if (request.module < 0 ||
+      static_cast<std::size_t>(request.module) >= loaded->modules.size())
+    throw std::runtime_error("the IR has no module with index " +
+                             std::to_string(request.module));
+  const gtirb_pprint::PreparedModule& prepared =
+      *loaded->modules[request.module];
+
+  gtirb_pprint::PrettyPrinter pp;
+  pp.setDebug(request.debug);
+  pp.setCompact(request.compact);
+  pp.setTarget(gtirb_pprint::resolveTarget(prepared.getModule(),
+                                           request.format, request.syntax));
+  for (const auto& keep : request.keepFunctions)
+    pp.keepFunction(keep);
+  for (const auto& skip : request.skipFunctions)
+    pp.skipFunction(skip);
+
+  std::ostringstream body;
+  if (pp.print(body, prepared) || !body)
+    throw std::runtime_error("could not print the module");
+  return body.str();
+}
+
+/// A client connection. Requests are read and responses written
+/// asynchronously by the thread running the io_context, and only the printing
+/// itself runs on the thread pool, so idle connections do not hold threads.
+/// The connection keeps itself alive while an operation is pending.
+class Connection : public std::enable_shared_from_this<Connection> {
+public:
+  Connection(stream_protocol::socket socket_, asio::thread_pool& pool_,
+             IRCache& cache_)
+      : socket(std::move(socket_)), pool(pool_), cache(cache_) {}
+
+  void readRequest() {
+    auto self = shared_from_this();
+    asio::async_read_until(
+        socket, buffer, "\n\n",
+        [self](const boost::system::error_code& ec, std::size_t) {
+          if (!ec)
+            self->serveRequest();
+        });
+  }
+
+private:
+  void serveRequest() {
+    // Parse on this thread: it only consumes the request from the buffer,
+    // which leaves any following request in place.
+    std::optional<Request> request;
+    try {
+      std::istream in(&buffer);
+      request = parseRequest(in);
+    } catch (const std::exception& e) {
+      writeResponse(errorResponse(e));
+      return;
+    }
+    auto self = shared_from_this();
+    asio::post(pool, [self, request = std::move(*request)]() {
+      std::string result;
+      try {
+        std::string body = serve(request, self->cache);
+        result = "OK " + std::to_string(body.size()) + "\n" + body;
+      } catch (const std::exception& e) {
+        result = errorResponse(e);
+      }
+      asio::post(self->socket.get_executor(),
+                 [self, result = std::move(result)]() mutable {
+                   self->writeResponse(std::move(result));
+                 });
+    });
+  }
+
+  void writeResponse(std::string response_) {
+    response = std::move(response_);
+    auto self = shared_from_this();
+    asio::async_write(
+        socket, asio::buffer(response),
+        [self](const boost::system::error_code& ec, std::size_t) {
+          if (!ec)
+            self->readRequest();
+        });
+  }
+
+  static std::string errorResponse(const std::exception& e) {
+    std::string message = e.what();
+    std::replace(message.begin(), message.end(), '\n', ' ');
+    return "ERROR " + message + "\n";
+  }
+
+  stream_protocol::socket socket;
+  asio::thread_pool& pool;
+  IRCache& cache;
+  asio::streambuf buffer;
+  std::string response;
+};
+
+} // namespace
+
+int runPrintServer(const std::string& socketPath, std::size_t threads,
+                   std::size_t cacheSize) {
+  IRCache cache(std::max<std::size_t>(cacheSize, 1));
+  asio::io_context io;
+
+  // Remove a stale socket left by a previous server.
+  std::error_code removeError;
+  fs::remove(socketPath, removeError);
+
+  boost::system::error_code ec;
+  stream_protocol::acceptor acceptor(io);
+  acceptor.open(stream_protocol(), ec);
+  if (!ec)
+    acceptor.bind(stream_protocol::endpoint(socketPath), ec);
+  if (!ec)
+    acceptor.listen(asio::socket_base::max_listen_connections, ec);
+  if (ec) {
+    LOG_ERROR << "Could not listen on " << socketPath << ": " << ec.message()
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Stop on SIGINT or SIGTERM: no new connection is accepted, the requests
+  // being printed are completed, and the other connections are closed.
+  asio::signal_set signals(io, SIGINT, SIGTERM);
+  signals.async_wait([&](const boost::system::error_code&, int) {
+    LOG_INFO << "Shutting down" << std::endl;
+    acceptor.close();
+    io.stop();
+  });
+
+  asio::thread_pool pool(std::max<std::size_t>(threads, 1));
+  int status = EXIT_SUCCESS;
+  std::function<void()> acceptNext = [&]() {
+    acceptor.async_accept([&](const boost::system::error_code& acceptError,
+                              stream_protocol::socket socket) {
+      if (acceptError == asio::error::operation_aborted)
+        return;
+      if (acceptError) {
+        LOG_ERROR << "Could not accept connection: " << acceptError.message()
+                  << std::endl;
+        status = EXIT_FAILURE;
+        io.stop();
+        return;
+      }
+      std::make_shared<Connection>(std::move(socket), pool, cache)
+          ->readRequest();
+      acceptNext();
+    });
+  };
+  acceptNext();
+
+  LOG_INFO << "Serving on " << socketPath << std::endl;
+  io.run();
+  pool.join();
+  fs::remove(socketPath, removeError);
+  return status;
+}
+
+#else
+
+int runPrintServer(const std::string& /* socketPath */,
+                   std::size_t /* threads */, std::size_t /* cacheSize */) {
+  LOG_ERROR << "Serving requests requires Unix domain sockets, which are not "
+               "available on this platform."
+            << std::endl;
+  return EXIT_FAILURE;
+}
+
+#endif // BOOST_ASIO_HAS_LOCAL_SOCKETS
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/// Serve pretty-printing requests on a Unix domain socket until the process
+/// receives SIGINT or SIGTERM. Loaded IRs are kept in an LRU cache keyed by
+/// file path and modification time. Connections are read asynchronously and
+/// each request is printed as its own task on a pool of threads, so idle
+/// connections do not occupy the pool. Requests printing the same module
+/// share its PreparedModule and are printed concurrently.
+///
+/// A connection carries any number of requests. Each request is a sequence of
+/// "key=value" lines terminated by an empty line:
+///
+///   ir=PATH             the IR file to print (required)
+///   module=N            index of the module to print (default 0)
+///   format=FORMAT       target format (default: the module's file format)
+///   syntax=SYNTAX       target syntax (default: the format's default syntax)
+///   debug=1             turn on debugging messages
+///   compact=1           print the compact output
+///   skip-function=NAME  do not print the function (repeatable)
+///   keep-function=NAME  print the function even if skipped by default
+///                       (repeatable)
+///
+/// The response is either "OK <size>\n" followed by <size> bytes of assembly,
+/// or "ERROR <message>\n". The server only writes to its socket.
+///
+/// \param socketPath the path of the socket to listen on
+/// \param threads    the number of requests served concurrently
+/// \param cacheSize  the maximum number of IRs kept in memory
+///
+/// \return the exit code of the server: EXIT_SUCCESS when stopped by a
+/// signal, EXIT_FAILURE when the socket could not be served.
+int runPrintServer(const std::string& socketPath, std::size_t threads,
+                   std::size_t cacheSize);
@@ -1,9 +1,12 @@
 #include "ElfBinaryPrinter.hpp"
+#include "ElfObjectBinaryPrinter.hpp"
 #include "Logger.h"
+#include "Trace.hpp"
 #include <boost/program_options.hpp>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <optional>
 #ifdef USE_STD_FILESYSTEM_LIB
 #include <filesystem>
 namespace fs = std::filesystem;
@@ -32,6 +35,21 @@ int main(int argc, char** argv) {
   desc.add_options()("library-paths,L",
                      po::value<std::vector<std::string>>()->multitoken(),
                      "Library paths to be passed to the linker");
+  desc.add_options()("compact",
+                     "Leave out indentation and decorative comments and "
+                     "shorten NOP padding. The assembled code is unchanged.");
+  desc.add_options()("direct-objects",
+                     "Write object files directly instead of printing and "
+                     "assembling assembly code.");
+  desc.add_options()(
+      "cache-dir", po::value<std::string>(),
+      "Reuse the object files and binaries of previous runs from the given "
+      "directory: unchanged modules are not assembled again, and unchanged "
+      "binaries are not linked again.");
+  desc.add_options()("trace", po::value<std::string>(),
+                     "Write a timeline of the IR load, the printing and the "
+                     "compiler runs to the given file, in the Chrome trace "
+                     "event format.");
   po::positional_options_description pd;
   pd.add("ir", -1);
   po::variables_map vm;
@@ -50,6 +68,11 @@ int main(int argc, char** argv) {
   }
   po::notify(vm);
 
+  // Record everything from here to the end of main.
+  std::optional<gtirb_pprint::trace::TraceFile> traceFile;
+  if (vm.count("trace") != 0)
+    traceFile.emplace(vm["trace"].as<std::string>());
+
   gtirb::Context ctx;
   gtirb::IR* ir;
 
@@ -59,12 +82,14 @@ int main(int argc, char** argv) {
       LOG_INFO << std::setw(24) << std::left << "Reading IR: " << irPath
                << std::endl;
       std::ifstream in(irPath.string(), std::ios::in | std::ios::binary);
+      gtirb_pprint::trace::Span span("io", "load IR", irPath.string());
       ir = gtirb::IR::load(ctx, in);
     } else {
       LOG_ERROR << "IR not found: \"" << irPath << "\".";
       return EXIT_FAILURE;
     }
   } else {
+    gtirb_pprint::trace::Span span("io", "load IR", "<stdin>");
     ir = gtirb::IR::load(ctx, std::cin);
   }
   if (ir->modules().empty()) {
@@ -75,6 +100,7 @@ int main(int argc, char** argv) {
   // Perform the Pretty Printing step.
   gtirb_pprint::PrettyPrinter pp;
   pp.setDebug(vm.count("debug"));
+  pp.setCompact(vm.count("compact"));
   const std::string& format =
       gtirb_pprint::getModuleFileFormat(*ir->modules().begin());
   const std::string& syntax =
@@ -111,7 +137,18 @@ int main(int argc, char** argv) {
   }
 
   if (vm.count("binary") != 0) {
-    gtirb_bprint::ElfBinaryPrinter binaryPrinter(true);
+    std::unique_ptr<gtirb_bprint::BinaryPrinter> binaryPrinter;
+    if (vm.count("direct-objects") != 0) {
+      if (vm.count("cache-dir") != 0)
+        LOG_INFO << "The cache is not used with --direct-objects" << std::endl;
+      binaryPrinter =
+          std::make_unique<gtirb_bprint::ElfObjectBinaryPrinter>(true);
+    } else {
+      auto elfPrinter = std::make_unique<gtirb_bprint::ElfBinaryPrinter>(true);
+      if (vm.count("cache-dir") != 0)
+        elfPrinter->setCacheDirectory(vm["cache-dir"].as<std::string>());
+      binaryPrinter = std::move(elfPrinter);
+    }
     const auto binaryPath = fs::path(vm["binary"].as<std::string>());
     std::vector<std::string> extraCompilerArgs;
     if (vm.count("compiler-args") != 0)
@@ -119,8 +156,8 @@ int main(int argc, char** argv) {
     std::vector<std::string> libraryPaths;
     if (vm.count("library-paths") != 0)
       libraryPaths = vm["library-paths"].as<std::vector<std::string>>();
-    binaryPrinter.link(binaryPath.string(), extraCompilerArgs, libraryPaths, pp,
-                       ctx, *ir);
+    binaryPrinter->link(binaryPath.string(), extraCompilerArgs, libraryPaths,
+                        pp, ctx, *ir);
   } else {
     LOG_INFO << "Please specify a binary name" << std::endl;
   }
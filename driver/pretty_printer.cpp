@@ -1,33 +1,174 @@
+#include "AllocationStats.hpp"
+#include "AssemblyIndex.hpp"
+#include "AsyncStreamBuf.hpp"
+#include "BatchPrinter.hpp"
+#include "ChunkGenerator.hpp"
 #include "ElfBinaryPrinter.hpp"
+#include "ModuleDiff.hpp"
 #include "Logger.h"
 #include "PrettyPrinter.hpp"
+#include "PrintServer.hpp"
+#include "Trace.hpp"
 #include <boost/program_options.hpp>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
-#ifdef USE_STD_FILESYSTEM_LIB
-#include <filesystem>
-namespace fs = std::filesystem;
-#else
-#include <experimental/filesystem>
-namespace fs = std::experimental::filesystem;
-#endif // USE_STD_FILESYSTEM_LIB
+#include <memory>
+#include <optional>
+#include <thread>
 
 namespace po = boost::program_options;
 
-static fs::path getAsmFileName(const fs::path& InitialPath, int Index) {
-  if (Index == 0)
-    return InitialPath;
-  std::string Filename = InitialPath.filename().generic_string();
-  // If the name does not have an extension, we add the number at the end.
-  size_t LastDot = Filename.rfind('.');
-  if (LastDot == std::string::npos)
-    Filename.append(std::to_string(Index));
-  // Otherwise, we add the number before the extension.
-  Filename.insert(LastDot, std::to_string(Index));
-  return fs::path(InitialPath).replace_filename(Filename);
+static gtirb::Module* getModule(gtirb::IR& ir, int index) {
+  int i = 0;
+  for (gtirb::Module& m : ir.modules()) {
+    if (i == index)
+      return &m;
+    ++i;
+  }
+  LOG_ERROR << "The ir has " << i << " modules, module with index " << index
+            << " cannot be printed" << std::endl;
+  return nullptr;
+}
+
+static std::optional<gtirb::Addr> parseAddress(const std::string& text) {
+  try {
+    size_t parsed;
+    uint64_t addr = std::stoull(text, &parsed, 0);
+    if (parsed != text.size())
+      return std::nullopt;
+    return gtirb::Addr(addr);
+  } catch (const std::logic_error&) {
+    return std::nullopt;
+  }
+}
+
+static std::optional<std::pair<gtirb::Addr, gtirb::Addr>>
+parseRange(const std::string& range) {
+  size_t sep = range.find(':');
+  if (sep == std::string::npos)
+    return std::nullopt;
+  auto start = parseAddress(range.substr(0, sep));
+  auto end = parseAddress(range.substr(sep + 1));
+  if (!start || !end)
+    return std::nullopt;
+  return std::make_pair(*start, *end);
+}
+
+// Print a module through a chunk generator, recording where each element
+// lands in the output in a sidecar index.
+static bool printIndexed(const gtirb_pprint::PrettyPrinter& pp,
+                         gtirb::Context& ctx, gtirb::Module& module,
+                         std::ostream& out, const fs::path& indexPath) {
+  std::ofstream ofs(indexPath);
+  if (!ofs) {
+    LOG_ERROR << "Could not open index file: " << indexPath << std::endl;
+    return false;
+  }
+  gtirb_pprint::PreparedModule prepared(ctx, module);
+  gtirb_pprint::AssemblyIndex index(prepared);
+  gtirb_pprint::ChunkGenerator chunks = pp.generate(prepared);
+  while (auto chunk = chunks.next()) {
+    out << chunk->text;
+    index.add(*chunk);
+  }
+  index.write(ofs);
+  return true;
 }
 
+// Print a whole module, optionally with an index or one section at a time.
+// The output is written by a separate thread, so that printing goes on while
+// it is written. Return false if the module could not be printed or written.
+static bool printModule(const gtirb_pprint::PrettyPrinter& pp,
+                        gtirb::Context& ctx, gtirb::Module& module,
+                        std::ostream& os,
+                        const std::optional<fs::path>& indexPath,
+                        std::optional<std::size_t> streaming) {
+  gtirb_pprint::AsyncStreamBuf buffer(*os.rdbuf());
+  std::ostream out(&buffer);
+  bool printed;
+  if (indexPath)
+    printed = printIndexed(pp, ctx, module, out, *indexPath);
+  else if (streaming)
+    printed = !pp.printStreaming(out, ctx, module, *streaming);
+  else
+    printed = !pp.print(out, ctx, module);
+  // Flushing waits for the writing thread, and fails the stream if any of
+  // its writes failed.
+  out.flush();
+  if (printed && out.fail()) {
+    LOG_ERROR << "Could not write the assembly" << std::endl;
+    return false;
+  }
+  return printed;
+}
+
+// Load an IR, reporting why it could not be loaded. The name is only used in
+// the trace and the error messages.
+static gtirb::IR* loadIR(gtirb::Context& ctx, std::istream& in,
+                         const std::string& name) {
+  gtirb_pprint::trace::Span span("io", "load IR", name);
+  gtirb::IR* ir = gtirb::IR::load(ctx, in);
+  if (!ir)
+    LOG_ERROR << "Could not load IR: " << name << std::endl;
+  return ir;
+}
+
+static gtirb::IR* loadIR(gtirb::Context& ctx, const fs::path& irPath) {
+  if (!fs::exists(irPath)) {
+    LOG_ERROR << "IR not found: \"" << irPath << "\"." << std::endl;
+    return nullptr;
+  }
+  std::ifstream in(irPath.string(), std::ios::in | std::ios::binary);
+  return loadIR(ctx, in, irPath.string());
+}
+
+// Print the elements of a module that differ between two IRs.
+static int printIRDiff(const std::vector<std::string>& irPaths,
+                       int moduleIndex, const BatchOptions& options) {
+  if (irPaths.size() != 2) {
+    LOG_ERROR << "--diff expects the old and the new IR" << std::endl;
+    return EXIT_FAILURE;
+  }
+  // The versions usually share UUIDs, so each needs its own context.
+  gtirb::Context fromContext, toContext;
+  gtirb::IR* from = loadIR(fromContext, irPaths[0]);
+  gtirb::IR* to = loadIR(toContext, irPaths[1]);
+  if (!from || !to)
+    return EXIT_FAILURE;
+  gtirb::Module* fromModule = getModule(*from, moduleIndex);
+  gtirb::Module* toModule = getModule(*to, moduleIndex);
+  if (!fromModule || !toModule)
+    return EXIT_FAILURE;
+
+  gtirb_pprint::PrettyPrinter pp;
+  try {
+    configurePrinter(pp, options, *fromModule);
+  } catch (const std::exception& e) {
+    LOG_ERROR << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::cout << "--- " << irPaths[0] << " (module " << moduleIndex << ")\n"
+            << "+++ " << irPaths[1] << " (module " << moduleIndex << ")\n";
+  gtirb_pprint::DiffSummary summary = gtirb_pprint::printDiff(
+      std::cout, pp, gtirb_pprint::PreparedModule(fromContext, *fromModule),
+      gtirb_pprint::PreparedModule(toContext, *toModule));
+  LOG_INFO << summary.changed << " changed, " << summary.added << " added, "
+           << summary.removed << " removed, " << summary.unchanged
+           << " unchanged elements" << std::endl;
+  return EXIT_SUCCESS;
+}
+
+// Report the allocations counted during its lifetime, whichever way main
+// returns.
+class AllocationReport {
+public:
+  AllocationReport() { gtirb_pprint::allocation_stats::reset(); }
+  AllocationReport(const AllocationReport&) = delete;
+  AllocationReport& operator=(const AllocationReport&) = delete;
+  ~AllocationReport() { gtirb_pprint::allocation_stats::report(std::cerr); }
+};
+
 int main(int argc, char** argv) {
   po::options_description desc("Allowed options");
   desc.add_options()("help,h", "Produce help message.");
@@ -46,6 +187,9 @@ int main(int argc, char** argv) {
   desc.add_options()("syntax,s", po::value<std::string>(),
                      "The syntax of the assembly file to generate.");
   desc.add_options()("debug,d", "Turn on debugging (will break assembly)");
+  desc.add_options()("compact",
+                     "Leave out indentation and decorative comments and "
+                     "shorten NOP padding. The assembled code is unchanged.");
   desc.add_options()("keep-functions,k",
                      po::value<std::vector<std::string>>()->multitoken(),
                      "Print the given functions even if they are skipped by "
@@ -53,6 +197,75 @@ int main(int argc, char** argv) {
   desc.add_options()("skip-functions,n",
                      po::value<std::vector<std::string>>()->multitoken(),
                      "Do not print the given functions.");
+  desc.add_options()("function", po::value<std::string>(),
+                     "Only print the named function of the module given with "
+                     "--module, even if it is skipped by default.");
+  desc.add_options()(
+      "range", po::value<std::string>(),
+      "Only print the blocks and data objects of the module given with "
+      "--module that start in the address range START:END (END excluded).");
+  desc.add_options()(
+      "index", po::value<std::string>(),
+      "Also write an index mapping the sections, functions and blocks of "
+      "each printed module to their byte ranges in the assembly output. "
+      "Indices of further modules are named like the assembly files.");
+  desc.add_options()(
+      "from", po::value<std::string>(),
+      "Print the module given with --module from the first block or data "
+      "object at or after the given address to its end, one element at a "
+      "time.");
+  desc.add_options()(
+      "streaming",
+      po::value<std::size_t>()->implicit_value(
+          gtirb_pprint::PrettyPrinter::DefaultStreamingBufferSize),
+      "Print each module one section at a time, so that the memory used does "
+      "not grow with the size of the module. The output is written whenever "
+      "the given number of bytes are pending.");
+  desc.add_options()(
+      "listing", po::value<std::vector<std::string>>()->multitoken(),
+      "Print the IR in several syntaxes at once. Each listing has the form "
+      "SYNTAX=FILE; IRs with several modules are written like with --asm. The "
+      "IR is traversed and disassembled once for all the listings.");
+  desc.add_options()(
+      "output,o", po::value<std::vector<std::string>>()->composing(),
+      "Print the IR to an assembly file described as FORMAT:SYNTAX:FLAGS:PATH. "
+      "May be repeated: the IR is loaded once and the outputs are printed "
+      "concurrently (see --jobs). Empty fields keep the other options; FLAGS "
+      "is a comma-separated list of debug, compact, skip=FUNCTION and "
+      "keep=FUNCTION. IRs with several modules are written like with --asm.");
+  desc.add_options()(
+      "serve", po::value<std::string>(),
+      "Serve printing requests on the given Unix domain socket instead of "
+      "printing a single IR.");
+  desc.add_options()("threads",
+                     po::value<unsigned>()->default_value(
+                         std::max(1u, std::thread::hardware_concurrency())),
+                     "The number of requests served concurrently.");
+  desc.add_options()("cache-size", po::value<unsigned>()->default_value(8),
+                     "The maximum number of IRs kept loaded when serving "
+                     "requests.");
+  desc.add_options()(
+      "batch", po::value<std::string>(),
+      "Print every IR listed in the given file instead of a single IR. Each "
+      "line names an input IR and the assembly file to write.");
+  desc.add_options()("jobs,j",
+                     po::value<unsigned>()->default_value(
+                         std::max(1u, std::thread::hardware_concurrency())),
+                     "The number of files printed concurrently in batch "
+                     "mode or with --output.");
+  desc.add_options()(
+      "diff", po::value<std::vector<std::string>>()->multitoken(),
+      "Print the blocks and data objects of the module (see --module) that "
+      "differ between two IRs, given as OLD NEW. Unchanged elements are not "
+      "formatted.");
+  desc.add_options()("trace", po::value<std::string>(),
+                     "Write a timeline of the IR load and of the printing "
+                     "done by every thread to the given file, in the Chrome "
+                     "trace event format.");
+  desc.add_options()("allocation-stats",
+                     "Report the heap allocations of each printing phase. "
+                     "Requires a build configured with "
+                     "GTIRB_PPRINTER_ALLOCATION_STATS=ON.");
   po::positional_options_description pd;
   pd.add("ir", -1);
   po::variables_map vm;
@@ -71,31 +284,85 @@ int main(int argc, char** argv) {
   }
   po::notify(vm);
 
+  if (vm.count("serve") != 0)
+    return runPrintServer(vm["serve"].as<std::string>(),
+                          vm["threads"].as<unsigned>(),
+                          vm["cache-size"].as<unsigned>());
+
+  // Record everything from here to the end of main.
+  std::optional<gtirb_pprint::trace::TraceFile> traceFile;
+  if (vm.count("trace") != 0)
+    traceFile.emplace(vm["trace"].as<std::string>());
+
+  BatchOptions options;
+  if (vm.count("format") != 0)
+    options.format = vm["format"].as<std::string>();
+  if (vm.count("syntax") != 0)
+    options.syntax = vm["syntax"].as<std::string>();
+  options.debug = vm.count("debug") != 0;
+  options.compact = vm.count("compact") != 0;
+  if (vm.count("keep-functions") != 0)
+    options.keepFunctions = vm["keep-functions"].as<std::vector<std::string>>();
+  if (vm.count("skip-functions") != 0)
+    options.skipFunctions = vm["skip-functions"].as<std::vector<std::string>>();
+
+  if (vm.count("batch") != 0)
+    return runBatch(vm["batch"].as<std::string>(), vm["jobs"].as<unsigned>(),
+                    options);
+
+  // Do we compare two versions of an IR?
+  if (vm.count("diff") != 0)
+    return printIRDiff(vm["diff"].as<std::vector<std::string>>(),
+                       vm["module"].as<int>(), options);
+
+  std::vector<OutputSpec> outputs;
+  if (vm.count("output") != 0) {
+    for (const auto& spec : vm["output"].as<std::vector<std::string>>()) {
+      std::optional<OutputSpec> output = parseOutputSpec(spec, options);
+      if (!output) {
+        LOG_ERROR << "Invalid output '" << spec
+                  << "', expected FORMAT:SYNTAX:FLAGS:PATH" << std::endl;
+        return EXIT_FAILURE;
+      }
+      outputs.push_back(std::move(*output));
+    }
+  }
+
   gtirb::Context ctx;
   gtirb::IR* ir;
-
   if (vm.count("ir") != 0) {
     fs::path irPath = vm["ir"].as<std::string>();
-    if (fs::exists(irPath)) {
-      LOG_INFO << std::setw(24) << std::left << "Reading IR: " << irPath
-               << std::endl;
-      std::ifstream in(irPath.string(), std::ios::in | std::ios::binary);
-      ir = gtirb::IR::load(ctx, in);
-    } else {
-      LOG_ERROR << "IR not found: \"" << irPath << "\".";
-      return EXIT_FAILURE;
-    }
+    LOG_INFO << std::setw(24) << std::left << "Reading IR: " << irPath
+             << std::endl;
+    ir = loadIR(ctx, irPath);
   } else {
-    ir = gtirb::IR::load(ctx, std::cin);
+    ir = loadIR(ctx, std::cin, "<stdin>");
   }
+  if (!ir)
+    return EXIT_FAILURE;
   if (ir->modules().empty()) {
-    LOG_ERROR << "IR has no modules";
+    LOG_ERROR << "IR has no modules" << std::endl;
     return EXIT_FAILURE;
   }
 
+  // Count the allocations of printing, not of loading the IR.
+  std::optional<AllocationReport> allocationReport;
+  if (vm.count("allocation-stats") != 0) {
+    if (gtirb_pprint::allocation_stats::enabled())
+      allocationReport.emplace();
+    else
+      LOG_INFO << "Allocations are not counted in this build; configure "
+                  "with GTIRB_PPRINTER_ALLOCATION_STATS=ON\n";
+  }
+
+  // Do we print several outputs at once?
+  if (!outputs.empty())
+    return printOutputs(ctx, *ir, outputs, vm["jobs"].as<unsigned>());
+
   // Perform the Pretty Printing step.
   gtirb_pprint::PrettyPrinter pp;
   pp.setDebug(vm.count("debug"));
+  pp.setCompact(vm.count("compact"));
   const std::string& format =
       vm.count("format")
           ? vm["format"].as<std::string>()
@@ -134,6 +401,102 @@ int main(int argc, char** argv) {
     }
   }
 
+  // Do we print only part of a module?
+  if (vm.count("function") != 0 || vm.count("range") != 0 ||
+      vm.count("from") != 0) {
+    gtirb::Module* module = getModule(*ir, vm["module"].as<int>());
+    if (!module)
+      return EXIT_FAILURE;
+    std::ofstream ofs;
+    if (vm.count("asm") != 0) {
+      ofs.open(vm["asm"].as<std::string>());
+      if (!ofs) {
+        LOG_ERROR << "Could not output assembly output file: "
+                  << vm["asm"].as<std::string>() << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+    std::ostream& out = ofs.is_open() ? ofs : std::cout;
+    // Only the printed part of the module is prepared.
+    if (vm.count("function") != 0) {
+      const std::string& name = vm["function"].as<std::string>();
+      gtirb_pprint::PreparedModule prepared(
+          ctx, *module,
+          gtirb_pprint::PreparedModule::findFunctions(ctx, *module, name));
+      if (pp.printFunction(out, prepared, name)) {
+        LOG_ERROR << "No function named '" << name << "'" << std::endl;
+        return EXIT_FAILURE;
+      }
+    } else if (vm.count("from") != 0) {
+      auto start = parseAddress(vm["from"].as<std::string>());
+      if (!start) {
+        LOG_ERROR << "Invalid address '" << vm["from"].as<std::string>() << "'"
+                  << std::endl;
+        return EXIT_FAILURE;
+      }
+      gtirb_pprint::ChunkGenerator chunks = pp.generate(ctx, *module);
+      chunks.seek(*start);
+      while (auto chunk = chunks.next())
+        out << chunk->text;
+    } else {
+      auto range = parseRange(vm["range"].as<std::string>());
+      if (!range) {
+        LOG_ERROR << "Invalid range '" << vm["range"].as<std::string>()
+                  << "', expected START:END" << std::endl;
+        return EXIT_FAILURE;
+      }
+      gtirb_pprint::PreparedModule prepared(ctx, *module, range->first,
+                                            range->second);
+      pp.printRange(out, prepared, range->first, range->second);
+    }
+    return EXIT_SUCCESS;
+  }
+
+  // Do we print several syntaxes at once?
+  if (vm.count("listing") != 0) {
+    std::vector<std::tuple<std::string, fs::path>> listings;
+    for (const auto& listing :
+         vm["listing"].as<std::vector<std::string>>()) {
+      size_t sep = listing.find('=');
+      if (sep == std::string::npos) {
+        LOG_ERROR << "Invalid listing '" << listing
+                  << "', expected SYNTAX=FILE" << std::endl;
+        return EXIT_FAILURE;
+      }
+      std::string listingSyntax = listing.substr(0, sep);
+      if (gtirb_pprint::getRegisteredTargets().count(
+              std::make_tuple(format, listingSyntax)) == 0) {
+        LOG_ERROR << "Unsupported combination: format '" << format
+                  << "' and syntax '" << listingSyntax << "'" << std::endl;
+        return EXIT_FAILURE;
+      }
+      listings.emplace_back(listingSyntax, listing.substr(sep + 1));
+    }
+    int i = 0;
+    for (gtirb::Module& m : ir->modules()) {
+      std::vector<std::unique_ptr<std::ofstream>> files;
+      std::vector<gtirb_pprint::PrettyPrinter::TargetStream> targets;
+      for (const auto& [listingSyntax, path] : listings) {
+        fs::path name = getAsmFileName(path, i);
+        files.push_back(std::make_unique<std::ofstream>(name));
+        if (!*files.back()) {
+          LOG_ERROR << "Could not open listing file: " << name << std::endl;
+          return EXIT_FAILURE;
+        }
+        targets.emplace_back(std::make_tuple(format, listingSyntax),
+                             files.back().get());
+      }
+      pp.print(targets, gtirb_pprint::PreparedModule(ctx, m));
+      LOG_INFO << "Module " << i << "'s listings written" << std::endl;
+      ++i;
+    }
+    return EXIT_SUCCESS;
+  }
+
+  std::optional<std::size_t> streaming;
+  if (vm.count("streaming") != 0)
+    streaming = vm["streaming"].as<std::size_t>();
+
   // Do we write it to a file?
   if (vm.count("asm") != 0) {
     const auto asmPath = fs::path(vm["asm"].as<std::string>());
@@ -147,7 +510,11 @@ int main(int argc, char** argv) {
       fs::path name = getAsmFileName(asmPath, i);
       std::ofstream ofs(name);
       if (ofs) {
-        pp.print(ofs, ctx, m);
+        std::optional<fs::path> indexPath;
+        if (vm.count("index") != 0)
+          indexPath = getAsmFileName(vm["index"].as<std::string>(), i);
+        if (!printModule(pp, ctx, m, ofs, indexPath, streaming))
+          return EXIT_FAILURE;
         LOG_INFO << "Module " << i << "'s assembly written to: " << name
                  << "\n";
       } else {
@@ -158,21 +525,14 @@ int main(int argc, char** argv) {
     }
     // or to the standard output
   } else {
-    gtirb::Module* module = nullptr;
-    int i = 0;
-    for (gtirb::Module& m : ir->modules()) {
-      if (i == vm["module"].as<int>()) {
-        module = &m;
-        break;
-      }
-      ++i;
-    }
-    if (!module) {
-      LOG_ERROR << "The ir has " << i << " modules, module with index "
-                << vm["module"].as<int>() << " cannot be printed" << std::endl;
+    gtirb::Module* module = getModule(*ir, vm["module"].as<int>());
+    if (!module)
+      return EXIT_FAILURE;
+    std::optional<fs::path> indexPath;
+    if (vm.count("index") != 0)
+      indexPath = vm["index"].as<std::string>();
+    if (!printModule(pp, ctx, *module, std::cout, indexPath, streaming))
       return EXIT_FAILURE;
-    }
-    pp.print(std::cout, ctx, *module);
   }
 
   return EXIT_SUCCESS;
@@ -0,0 +1,96 @@
+//===- AllocationStats.hpp --------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2019 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GTIRB_PP_ALLOCATION_STATS_H
+#define GTIRB_PP_ALLOCATION_STATS_H
+
+#include "Export.hpp"
+
+#include <cstdint>
+#include <iosfwd>
+
+namespace gtirb_pprint {
+
+/// Heap allocations made while printing, counted per printing phase when the
+/// library is configured with GTIRB_PPRINTER_ALLOCATION_STATS=ON. The library
+/// then replaces the global operator new to count the allocations of every
+/// thread; otherwise nothing is counted and the phases cost nothing.
+namespace allocation_stats {
+
+/// What the printer is doing when it allocates. Phases nest: an allocation is
+/// attributed to the innermost phase of its thread.
+enum class Phase {
+  /// Outside any phase, e.g. in the caller.
+  Other,
+  /// Building a PreparedModule and creating printers.
+  Setup,
+  /// The file header and footer.
+  FileHeader,
+  /// What precedes an element: section headers and footers, symbols.
+  SectionHeader,
+  /// A block, including its function header and its instructions.
+  Block,
+  /// An instruction.
+  Instruction,
+  /// A data object.
+  DataObject,
+  /// A reference to a symbol, in an instruction or a data object.
+  SymbolReference,
+  Count
+};
+
+struct Counters {
+  /// The number of elements of the phase, e.g. instructions, printed.
+  uint64_t elements = 0;
+  uint64_t allocations = 0;
+  uint64_t bytes = 0;
+};
+
+/// Whether allocations are counted in this build of the library.
+DEBLOAT_PRETTYPRINTER_EXPORT_API bool enabled();
+
+/// The counters of a phase, summed over all the threads.
+DEBLOAT_PRETTYPRINTER_EXPORT_API Counters get(Phase phase);
+
+/// Reset the counters of all the phases.
+DEBLOAT_PRETTYPRINTER_EXPORT_API void reset();
+
+/// Print a table of the counters of every phase, with the allocations per
+/// element, and the allocations per instruction of the whole print.
+DEBLOAT_PRETTYPRINTER_EXPORT_API void report(std::ostream& os);
+
+/// Attribute the allocations of the current thread to a phase while in
+/// scope, and count one element of the phase.
+class DEBLOAT_PRETTYPRINTER_EXPORT_API Scope {
+public:
+#ifdef GTIRB_PPRINTER_ALLOCATION_STATS
+  explicit Scope(Phase phase);
+  ~Scope();
+#else
+  explicit Scope(Phase) {}
+#endif // GTIRB_PPRINTER_ALLOCATION_STATS
+
+  Scope(const Scope&) = delete;
+  Scope& operator=(const Scope&) = delete;
+
+#ifdef GTIRB_PPRINTER_ALLOCATION_STATS
+private:
+  Phase previous;
+#endif // GTIRB_PPRINTER_ALLOCATION_STATS
+};
+
+} // namespace allocation_stats
+} // namespace gtirb_pprint
+
+#endif /* GTIRB_PP_ALLOCATION_STATS_H */
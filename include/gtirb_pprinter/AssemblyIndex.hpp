@@ -0,0 +1,81 @@
+//===- AssemblyIndex.hpp ----------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2019 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GTIRB_PP_ASSEMBLY_INDEX_H
+#define GTIRB_PP_ASSEMBLY_INDEX_H
+
+#include "ChunkGenerator.hpp"
+#include "Export.hpp"
+#include "PreparedModule.hpp"
+
+#include <gtirb/gtirb.hpp>
+
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <optional>
+#include <vector>
+
+namespace gtirb_pprint {
+
+/// Maps the sections, functions and blocks of a module to the byte ranges of
+/// their assembly code in the output of a \link ChunkGenerator.
+///
+/// Every chunk must be passed to add() in the order it is written, starting
+/// at offset 0 of the output. The index is written as text, one entry per
+/// line:
+///
+///     section NAME ADDRESS BEGIN END HASH
+///     function NAME ADDRESS BEGIN END
+///     block ADDRESS BEGIN END
+///
+/// where BEGIN and END are the byte offsets of the entry in the output (END
+/// excluded) and HASH is the 64-bit FNV-1a hash of the section's text, which
+/// tells whether a section changed between two runs.
+class DEBLOAT_PRETTYPRINTER_EXPORT_API AssemblyIndex {
+public:
+  explicit AssemblyIndex(const PreparedModule& prepared);
+
+  /// Account for a chunk appended to the output.
+  void add(const AssemblyChunk& chunk);
+
+  /// Write the index of the chunks added so far.
+  void write(std::ostream& os) const;
+
+private:
+  struct Range {
+    gtirb::Addr address;
+    uint64_t begin;
+    uint64_t end;
+  };
+
+  struct SectionRange {
+    const gtirb::Section* section;
+    Range range;
+    uint64_t hash;
+  };
+
+  const PreparedModule& prepared;
+  uint64_t offset = 0;
+  std::optional<uint64_t> functionHeaderBegin;
+  std::vector<SectionRange> sections;
+  std::map<gtirb::Addr, Range> blocks;
+
+  const gtirb::Section* findSection(gtirb::Addr addr) const;
+  void extendSection(const AssemblyChunk& chunk, uint64_t begin);
+};
+
+} // namespace gtirb_pprint
+
+#endif /* GTIRB_PP_ASSEMBLY_INDEX_H */
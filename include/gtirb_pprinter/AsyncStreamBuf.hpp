@@ -0,0 +1,98 @@
+//===- AsyncStreamBuf.hpp ---------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2019 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GTIRB_PP_ASYNC_STREAM_BUF_H
+#define GTIRB_PP_ASYNC_STREAM_BUF_H
+
+#include "Export.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <streambuf>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace gtirb_pprint {
+
+/// An output stream buffer that writes to another stream buffer from a
+/// dedicated thread, so that printing does not stop while the output is
+/// written to a slow file or pipe.
+///
+/// The printer fills fixed-size buffers taken from a bounded pool and hands
+/// each full buffer to the writer thread, which returns it to the pool once
+/// written. When all the buffers are waiting to be written, the printer waits
+/// for the writer. Printing thus takes about as long as the slower of
+/// formatting and writing, instead of their sum.
+///
+/// The destination must not be used by anything else until the AsyncStreamBuf
+/// is destroyed or synced. Syncing, e.g. by flushing the stream, waits until
+/// everything is written.
+///
+/// For example, \code
+/// AsyncStreamBuf buffer(*std::cout.rdbuf());
+/// std::ostream out(&buffer);
+/// printer.print(out, context, module);
+/// \endcode
+class DEBLOAT_PRETTYPRINTER_EXPORT_API AsyncStreamBuf : public std::streambuf {
+public:
+  static constexpr std::size_t DefaultBufferSize = 1 << 16;
+  static constexpr std::size_t DefaultBufferCount = 4;
+
+  /// \param destination the stream buffer the output is written to
+  /// \param bufferSize  the size of each buffer of the pool
+  /// \param bufferCount the number of buffers of the pool, at least 2
+  explicit AsyncStreamBuf(std::streambuf& destination,
+                          std::size_t bufferSize = DefaultBufferSize,
+                          std::size_t bufferCount = DefaultBufferCount);
+
+  AsyncStreamBuf(const AsyncStreamBuf&) = delete;
+  AsyncStreamBuf& operator=(const AsyncStreamBuf&) = delete;
+
+  /// Write the pending output and stop the writer thread.
+  ~AsyncStreamBuf() override;
+
+protected:
+  int overflow(int c) override;
+  int sync() override;
+
+private:
+  using Buffer = std::vector<char>;
+
+  /// Hand the current buffer to the writer if it is not empty, and continue
+  /// in a free buffer. Return \c false if a write failed.
+  bool submit();
+  void writeBuffers();
+
+  std::streambuf& destination;
+  std::vector<Buffer> buffers;
+
+  std::mutex mutex;
+  std::condition_variable changed;
+  /// The buffers waiting to be written, with the size of their contents.
+  std::deque<std::pair<Buffer*, std::size_t>> fullBuffers;
+  std::vector<Buffer*> freeBuffers;
+  bool writing = false;
+  bool stopping = false;
+  bool failed = false;
+
+  Buffer* current;
+  std::thread writer;
+};
+
+} // namespace gtirb_pprint
+
+#endif /* GTIRB_PP_ASYNC_STREAM_BUF_H */
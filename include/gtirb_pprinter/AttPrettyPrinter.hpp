@@ -16,17 +16,31 @@
 #define GTIRB_PP_GAS_PRINTER_H
 
 #include "ElfPrettyPrinter.hpp"
+#include "StaticPrettyPrinter.hpp"
+
+#include <memory_resource>
+#include <string>
+#include <unordered_map>
 
 namespace gtirb_pprint {
 
 class AttPrettyPrinter : public ElfPrettyPrinter {
 public:
-  AttPrettyPrinter(gtirb::Context& context, gtirb::Module& module,
-                   const ElfSyntax& syntax, const PrintingPolicy& policy);
+  AttPrettyPrinter(
+      const PreparedModule& prepared, const ElfSyntax& syntax,
+      const PrintingPolicy& policy,
+      std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
 protected:
   std::string getRegisterName(unsigned int reg) const override;
 
+  /// Copy the shared instructions with their AT&T mnemonics and their
+  /// operands in AT&T order. The block is only decoded again if one of its
+  /// instruction forms has operands that are not the Intel ones reversed.
+  DecodedInstructions
+  adaptInstructions(const gtirb::Block& x,
+                    const DecodedInstructions& shared) override;
+
   void printHeader(std::ostream& os) override;
   void printOpRegdirect(std::ostream& os, const cs_insn& inst,
                         const cs_x86_op& op) override;
@@ -39,14 +53,32 @@ protected:
 
 private:
   static volatile bool registered;
+
+  /// The AT&T version of an instruction form.
+  struct Form {
+    std::pmr::string mnemonic;
+    /// Whether the AT&T operands are the Intel operands in AT&T order.
+    bool adaptable;
+  };
+
+  /// The instruction forms met in shared instructions, keyed by their Intel
+  /// mnemonics and their bytes without displacement and immediate. The
+  /// operand size suffixes of the AT&T mnemonics are not part of the Intel
+  /// decode, and a few forms list different operands in each syntax, so the
+  /// first instruction of each form is decoded again, alone.
+  std::pmr::unordered_map<std::pmr::string, Form> forms;
+
+  const Form& getForm(const cs_insn& shared);
 };
 
+extern template class StaticPrettyPrinter<AttPrettyPrinter>;
+
 class AttPrettyPrinterFactory : public PrettyPrinterFactory {
 public:
   const PrintingPolicy& defaultPrintingPolicy() const override;
   std::unique_ptr<PrettyPrinterBase>
-  create(gtirb::Context& context, gtirb::Module& module,
-         const PrintingPolicy& policy) override;
+  create(const PreparedModule& prepared, const PrintingPolicy& policy,
+         std::pmr::memory_resource* resource) override;
 };
 
 } // namespace gtirb_pprint
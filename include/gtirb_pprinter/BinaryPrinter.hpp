@@ -27,6 +27,7 @@ class BinaryPrinter {
 public:
   /// Construct a BinaryPrinter with the default configuration.
   BinaryPrinter() {}
+  virtual ~BinaryPrinter() = default;
   BinaryPrinter(const BinaryPrinter&) = default;
   BinaryPrinter(BinaryPrinter&&) = default;
   BinaryPrinter& operator=(const BinaryPrinter&) = default;
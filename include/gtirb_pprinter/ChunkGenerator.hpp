@@ -0,0 +1,138 @@
+//===- ChunkGenerator.hpp ---------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2019 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GTIRB_PP_CHUNK_GENERATOR_H
+#define GTIRB_PP_CHUNK_GENERATOR_H
+
+#include "Export.hpp"
+#include "PrettyPrinter.hpp"
+
+#include <gtirb/gtirb.hpp>
+
+#include <deque>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace gtirb_pprint {
+
+/// A piece of the assembly code of a module.
+struct AssemblyChunk {
+  enum class Kind {
+    /// The header of the assembly file.
+    Header,
+    /// What precedes an element: section footers and headers, symbols
+    /// defined after the previous element, or an overlap warning.
+    SectionHeader,
+    /// The header of the function starting with the next block.
+    FunctionHeader,
+    /// The instructions of a block.
+    Block,
+    /// A data object.
+    DataObject,
+    /// What follows the last element, including the footer of the file.
+    Footer
+  };
+
+  Kind kind;
+  /// The address of the element the chunk belongs to. For the file header
+  /// and footer, the address of the first or last element.
+  gtirb::Addr address;
+  std::string text;
+};
+
+/// Produces the assembly code of a module one chunk at a time, in address
+/// order. Each element is only formatted when its chunks are requested, so
+/// the time to the first chunk does not depend on the size of the module and
+/// the generator only holds the chunks of one element. Concatenating all the
+/// chunks gives the output of \link PrettyPrinter::print.
+///
+/// A generator either prints from a PreparedModule, or prepares the module
+/// itself one section at a time, as \link PrettyPrinter::printStreaming
+/// does. The latter only prepares the section of the first element printed
+/// before producing chunks, and the following sections as they are reached.
+///
+/// Create generators with \link PrettyPrinter::generate.
+class DEBLOAT_PRETTYPRINTER_EXPORT_API ChunkGenerator {
+public:
+  /// Print from a PreparedModule.
+  ///
+  /// \param resource the memory resource the printer was created with
+  /// \param printer  the printer formatting the chunks
+  ChunkGenerator(std::unique_ptr<std::pmr::memory_resource> resource,
+                 std::unique_ptr<PrettyPrinterBase> printer);
+
+  /// Prepare the module one section at a time.
+  ///
+  /// \param context the context of the module
+  /// \param module  the module to print, which must outlive the generator
+  /// \param factory the factory of the printers of the sections
+  /// \param policy  the printing policy of the printers
+  ChunkGenerator(gtirb::Context& context, gtirb::Module& module,
+                 std::shared_ptr<PrettyPrinterFactory> factory,
+                 PrintingPolicy policy);
+
+  ChunkGenerator(ChunkGenerator&&) = default;
+  ChunkGenerator& operator=(ChunkGenerator&&) = default;
+
+  /// Return the next non-empty chunk, or nothing after the footer.
+  std::optional<AssemblyChunk> next();
+
+  /// Continue with the first element starting at or after an address. The
+  /// header of its section is printed even if the section starts earlier, so
+  /// the chunks that follow keep their section context. The file header is
+  /// still produced first if it was not yet.
+  void seek(gtirb::Addr addr);
+
+private:
+  enum class Stage { Header, Elements, Footer, Done };
+
+  /// What a generator preparing the module itself needs to prepare the next
+  /// section. The index is only built once the generator goes past the
+  /// first section it prepared. The skipped ranges of the whole module are
+  /// built by the first printer and shared by the others.
+  struct Sections {
+    gtirb::Context* context;
+    gtirb::Module* module;
+    std::shared_ptr<PrettyPrinterFactory> factory;
+    PrintingPolicy policy;
+    std::vector<gtirb::Addr> starts;
+    size_t current;
+    std::unique_ptr<AddressIndex> index;
+    std::shared_ptr<const std::vector<AddrRange>> skippedRanges;
+  };
+
+  // Declared in the order they depend on each other, so that each is
+  // released before what it uses.
+  std::optional<Sections> sections;
+  std::unique_ptr<std::pmr::memory_resource> resource;
+  std::unique_ptr<PreparedModule> preparedSection;
+  std::unique_ptr<PrettyPrinterBase> printer;
+  Stage stage = Stage::Header;
+  size_t blockIndex = 0;
+  size_t dataIndex = 0;
+  gtirb::Addr last{0};
+  bool resumed = false;
+  std::deque<AssemblyChunk> pending;
+
+  void produceNextElement();
+  void prepareSection(size_t section);
+  void push(AssemblyChunk::Kind kind, gtirb::Addr address, std::string text);
+};
+
+} // namespace gtirb_pprint
+
+#endif /* GTIRB_PP_CHUNK_GENERATOR_H */
@@ -26,18 +26,42 @@
 namespace gtirb_bprint {
 class ElfBinaryPrinter : public BinaryPrinter {
 private:
-  std::string compiler = "gcc";
-  bool debug = false;
   std::optional<std::string>
   getInfixLibraryName(const std::string& library) const;
   std::optional<std::string>
   findLibrary(const std::string& library,
               const std::vector<std::string>& paths) const;
+
+protected:
+  std::string compiler = "gcc";
+  bool debug = false;
+  /// Where objects and binaries are cached; empty if not caching.
+  std::string cacheDirectory;
   std::vector<std::string> buildCompilerArgs(
       std::string outputFilename, const std::vector<std::string>& asmPath,
       const std::vector<std::string>& extraCompilerArgs,
       const std::vector<std::string>& userlibraryPaths, gtirb::IR& ir) const;
 
+  /// Run the compiler driver on the given input files (assembly or object
+  /// files) to produce the final binary.
+  int callCompiler(const std::string& outputFilename,
+                   const std::vector<std::string>& inputs,
+                   const std::vector<std::string>& extraCompilerArgs,
+                   const std::vector<std::string>& userLibraryPaths,
+                   gtirb::IR& ir) const;
+
+  /// Run the compiler driver with the given arguments.
+  int runCompiler(const std::vector<std::string>& args) const;
+
+  /// Link through the cache: each module is printed, then assembled only if
+  /// no object of the same assembly and arguments is cached, and the binary
+  /// is linked only if none of the same objects and arguments is cached.
+  int linkCached(const std::string& outputFilename,
+                 const std::vector<std::string>& extraCompilerArgs,
+                 const std::vector<std::string>& userLibraryPaths,
+                 const gtirb_pprint::PrettyPrinter& pp, gtirb::Context& ctx,
+                 gtirb::IR& ir) const;
+
 public:
   /// Construct a ElfBinaryPrinter with the default configuration.
   ElfBinaryPrinter() {}
@@ -48,11 +72,18 @@ public:
   ElfBinaryPrinter& operator=(const ElfBinaryPrinter&) = default;
   ElfBinaryPrinter& operator=(ElfBinaryPrinter&&) = default;
 
+  /// Reuse the object files and binaries of previous links from the given
+  /// directory, and add the new ones to it. Several links may share the
+  /// directory concurrently. An empty name disables the cache.
+  void setCacheDirectory(const std::string& directory) {
+    cacheDirectory = directory;
+  }
+
   int link(std::string outputFilename,
            const std::vector<std::string>& extraCompilerArgs,
            const std::vector<std::string>& userLibraryPaths,
            const gtirb_pprint::PrettyPrinter& pp, gtirb::Context& context,
-           gtirb::IR& ir) const;
+           gtirb::IR& ir) const override;
 };
 } // namespace gtirb_bprint
 
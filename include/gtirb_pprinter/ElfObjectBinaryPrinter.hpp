@@ -0,0 +1,73 @@
+//===- ElfObjectBinaryPrinter.hpp -------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2019 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GTIRB_PP_ELF_OBJECT_BINARY_PRINTER_H
+#define GTIRB_PP_ELF_OBJECT_BINARY_PRINTER_H
+
+#include "ElfBinaryPrinter.hpp"
+
+#include <gtirb/gtirb.hpp>
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+/// \brief ElfBinary-print GTIRB representations.
+namespace gtirb_bprint {
+
+/// Binary printer that writes each module directly as an ELF relocatable
+/// object instead of printing and assembling its assembly code. Section
+/// contents are copied from the ImageByteMap, the symbol table is built from
+/// the module's symbols, and the symbolic expressions become relocations. Only
+/// the final link goes through the compiler driver.
+///
+/// Sections and functions skipped by the printing policy are the ones the
+/// pretty printer skips: skipped sections are not emitted, and the symbols and
+/// relocations of skipped functions are dropped so the ones provided by the
+/// compiler's start files are used instead. The bytes of skipped functions
+/// stay in their section, so that the other code keeps its layout: this dead
+/// code is never called, but its references to other code and data are left
+/// unrelocated. Unwind information is not regenerated.
+class ElfObjectBinaryPrinter : public ElfBinaryPrinter {
+public:
+  /// Construct a ElfObjectBinaryPrinter with the default configuration.
+  ElfObjectBinaryPrinter() {}
+  ElfObjectBinaryPrinter(bool debugFlag) : ElfBinaryPrinter(debugFlag) {}
+
+  ElfObjectBinaryPrinter(const ElfObjectBinaryPrinter&) = default;
+  ElfObjectBinaryPrinter(ElfObjectBinaryPrinter&&) = default;
+  ElfObjectBinaryPrinter& operator=(const ElfObjectBinaryPrinter&) = default;
+  ElfObjectBinaryPrinter& operator=(ElfObjectBinaryPrinter&&) = default;
+
+  /// Write a module as an ELF relocatable object.
+  ///
+  /// \param out     the (binary) stream to write the object to
+  /// \param pp      the pretty printer whose policy selects what is emitted
+  /// \param context the context of the module
+  /// \param module  the module to write
+  ///
+  /// \return \c true if the object was written, \c false otherwise.
+  bool writeObject(std::ostream& out, const gtirb_pprint::PrettyPrinter& pp,
+                   gtirb::Context& context, gtirb::Module& module) const;
+
+  int link(std::string outputFilename,
+           const std::vector<std::string>& extraCompilerArgs,
+           const std::vector<std::string>& userLibraryPaths,
+           const gtirb_pprint::PrettyPrinter& pp, gtirb::Context& context,
+           gtirb::IR& ir) const override;
+};
+
+} // namespace gtirb_bprint
+
+#endif /* GTIRB_PP_ELF_OBJECT_BINARY_PRINTER_H */
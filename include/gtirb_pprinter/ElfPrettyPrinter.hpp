@@ -62,8 +62,10 @@ private:
 
 class ElfPrettyPrinter : public PrettyPrinterBase {
 public:
-  ElfPrettyPrinter(gtirb::Context& context, gtirb::Module& module,
-                   const ElfSyntax& syntax, const PrintingPolicy& policy);
+  ElfPrettyPrinter(
+      const PreparedModule& prepared, const ElfSyntax& syntax,
+      const PrintingPolicy& policy,
+      std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
   static const PrintingPolicy& defaultPrintingPolicy();
 
@@ -0,0 +1,50 @@
+//===- Fnv.hpp --------------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2019 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GTIRB_PP_FNV_H
+#define GTIRB_PP_FNV_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace gtirb_pprint {
+
+/// The 64-bit FNV-1a hash, used to compare printed sections and module
+/// elements. A hash is started from \c OffsetBasis and extended by calling
+/// \c fnv1a on each piece of data in turn.
+namespace fnv {
+
+constexpr uint64_t OffsetBasis = 0xcbf29ce484222325;
+constexpr uint64_t Prime = 0x100000001b3;
+
+/// Extend \p hash with \p size bytes at \p data.
+inline uint64_t fnv1a(uint64_t hash, const void* data, std::size_t size) {
+  const auto* bytes = static_cast<const unsigned char*>(data);
+  for (std::size_t i = 0; i < size; ++i) {
+    hash ^= bytes[i];
+    hash *= Prime;
+  }
+  return hash;
+}
+
+/// Extend \p hash with the characters of \p text.
+inline uint64_t fnv1a(uint64_t hash, std::string_view text) {
+  return fnv1a(hash, text.data(), text.size());
+}
+
+} // namespace fnv
+} // namespace gtirb_pprint
+
+#endif /* GTIRB_PP_FNV_H */
@@ -16,6 +16,7 @@
 #define GTIRB_PP_NASM_PRINTER_H
 
 #include "ElfPrettyPrinter.hpp"
+#include "StaticPrettyPrinter.hpp"
 
 namespace gtirb_pprint {
 
@@ -29,8 +30,10 @@ private:
 
 class IntelPrettyPrinter : public ElfPrettyPrinter {
 public:
-  IntelPrettyPrinter(gtirb::Context& context, gtirb::Module& module,
-                     const IntelSyntax& syntax, const PrintingPolicy& policy);
+  IntelPrettyPrinter(
+      const PreparedModule& prepared, const IntelSyntax& syntax,
+      const PrintingPolicy& policy,
+      std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
 protected:
   const IntelSyntax& intelSyntax;
@@ -49,12 +52,14 @@ private:
   static volatile bool registered;
 };
 
+extern template class StaticPrettyPrinter<IntelPrettyPrinter>;
+
 class IntelPrettyPrinterFactory : public PrettyPrinterFactory {
 public:
   const PrintingPolicy& defaultPrintingPolicy() const override;
   std::unique_ptr<PrettyPrinterBase>
-  create(gtirb::Context& context, gtirb::Module& module,
-         const PrintingPolicy& policy) override;
+  create(const PreparedModule& prepared, const PrintingPolicy& policy,
+         std::pmr::memory_resource* resource) override;
 };
 
 } // namespace gtirb_pprint
@@ -0,0 +1,64 @@
+//===- ModuleDiff.hpp -------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2019 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GTIRB_PP_MODULE_DIFF_H
+#define GTIRB_PP_MODULE_DIFF_H
+
+#include "Export.hpp"
+#include "PreparedModule.hpp"
+#include "PrettyPrinter.hpp"
+
+#include <cstddef>
+#include <iosfwd>
+
+namespace gtirb_pprint {
+
+/// The number of elements (blocks and data objects) of each kind in a
+/// module diff.
+struct DiffSummary {
+  std::size_t unchanged = 0;
+  std::size_t changed = 0;
+  std::size_t added = 0;
+  std::size_t removed = 0;
+};
+
+/// Print the blocks and data objects that differ between two versions of a
+/// module, in a unified-diff-like format:
+///
+///     @@ changed block 0x401000 -> 0x401010
+///     -<old assembly code>
+///     +<new assembly code>
+///     @@ added data object 0x404020
+///     +<new assembly code>
+///
+/// Elements are matched by UUID, then by a hash of their bytes and of the
+/// symbolic expressions in them, so moved elements are not reported. Elements
+/// matched by UUID whose hashes differ are formatted to tell whether only
+/// their addresses changed. The unchanged
+/// elements are hashed but never formatted, so the cost depends on the size of
+/// the change rather than on the size of the modules.
+///
+/// \param os       the stream to print to
+/// \param printer  the printer formatting the elements
+/// \param from     the old version of the module
+/// \param to       the new version of the module
+///
+/// \return the number of elements of each kind.
+DEBLOAT_PRETTYPRINTER_EXPORT_API DiffSummary printDiff(
+    std::ostream& os, const PrettyPrinter& printer, const PreparedModule& from,
+    const PreparedModule& to);
+
+} // namespace gtirb_pprint
+
+#endif /* GTIRB_PP_MODULE_DIFF_H */
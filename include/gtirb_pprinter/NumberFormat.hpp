@@ -0,0 +1,149 @@
+//===- NumberFormat.hpp -----------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2019 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GTIRB_PP_NUMBER_FORMAT_H
+#define GTIRB_PP_NUMBER_FORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+
+namespace gtirb_pprint {
+
+/// Integer formatting for the printers, which print integers for nearly every
+/// line. The digits are produced two at a time from lookup tables into a
+/// caller's buffer, then written to the stream unformatted, which avoids the
+/// locale and flag handling of the stream's number formatting.
+///
+/// Hexadecimal digits are lower case, without prefix and without leading
+/// zeros, like \c std::hex. Negative numbers are formatted in hexadecimal as
+/// their 64-bit two's complement, also like \c std::hex.
+namespace number_format {
+
+/// The most characters a hexadecimal number takes.
+constexpr std::size_t MaxHexSize = 16;
+/// The most characters a decimal number takes, sign included.
+constexpr std::size_t MaxDecimalSize = 20;
+
+namespace detail {
+struct DigitPairs {
+  char hex[512];
+  char decimal[200];
+
+  constexpr DigitPairs() : hex(), decimal() {
+    const char digits[] = "0123456789abcdef";
+    for (int i = 0; i < 256; ++i) {
+      hex[2 * i] = digits[i >> 4];
+      hex[2 * i + 1] = digits[i & 0xf];
+    }
+    for (int i = 0; i < 100; ++i) {
+      decimal[2 * i] = static_cast<char>('0' + i / 10);
+      decimal[2 * i + 1] = static_cast<char>('0' + i % 10);
+    }
+  }
+};
+
+inline constexpr DigitPairs Pairs{};
+
+inline std::size_t hexSize(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+  // One digit per started nibble; value | 1 gives one digit for zero.
+  return static_cast<std::size_t>(67 - __builtin_clzll(value | 1)) / 4;
+#else
+  std::size_t size = 1;
+  while (value >>= 4)
+    ++size;
+  return size;
+#endif // __GNUC__
+}
+
+inline std::size_t decimalSize(uint64_t value) {
+  std::size_t size = 1;
+  for (;;) {
+    if (value < 10)
+      return size;
+    if (value < 100)
+      return size + 1;
+    if (value < 1000)
+      return size + 2;
+    if (value < 10000)
+      return size + 3;
+    value /= 10000;
+    size += 4;
+  }
+}
+} // namespace detail
+
+/// Write \p value in hexadecimal at \p out, which must have room for
+/// MaxHexSize characters, and return the end of the digits.
+inline char* formatHex(char* out, uint64_t value) {
+  char* end = out + detail::hexSize(value);
+  char* p = end;
+  while (p - out >= 2) {
+    p -= 2;
+    std::memcpy(p, &detail::Pairs.hex[2 * (value & 0xff)], 2);
+    value >>= 8;
+  }
+  if (p != out)
+    *out = detail::Pairs.hex[2 * (value & 0xf) + 1];
+  return end;
+}
+
+/// Write \p value in decimal at \p out, which must have room for
+/// MaxDecimalSize characters, and return the end of the digits.
+inline char* formatDecimal(char* out, uint64_t value) {
+  char* end = out + detail::decimalSize(value);
+  char* p = end;
+  while (value >= 100) {
+    p -= 2;
+    std::memcpy(p, &detail::Pairs.decimal[2 * (value % 100)], 2);
+    value /= 100;
+  }
+  if (value >= 10)
+    std::memcpy(p - 2, &detail::Pairs.decimal[2 * value], 2);
+  else
+    p[-1] = static_cast<char>('0' + value);
+  return end;
+}
+
+/// Write \p value in decimal, with a minus sign if negative.
+inline char* formatDecimal(char* out, int64_t value) {
+  if (value >= 0)
+    return formatDecimal(out, static_cast<uint64_t>(value));
+  *out = '-';
+  // Negate as unsigned, which is defined for the smallest value too.
+  return formatDecimal(out + 1, 0 - static_cast<uint64_t>(value));
+}
+
+inline void writeHex(std::ostream& os, uint64_t value) {
+  char buffer[MaxHexSize];
+  os.write(buffer, formatHex(buffer, value) - buffer);
+}
+
+inline void writeDecimal(std::ostream& os, int64_t value) {
+  char buffer[MaxDecimalSize];
+  os.write(buffer, formatDecimal(buffer, value) - buffer);
+}
+
+inline std::string toHex(uint64_t value) {
+  char buffer[MaxHexSize];
+  return std::string(buffer, formatHex(buffer, value));
+}
+
+} // namespace number_format
+} // namespace gtirb_pprint
+
+#endif /* GTIRB_PP_NUMBER_FORMAT_H */
@@ -0,0 +1,235 @@
+//===- PreparedModule.hpp ---------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2019 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GTIRB_PP_PREPARED_MODULE_H
+#define GTIRB_PP_PREPARED_MODULE_H
+
+#include "Export.hpp"
+
+#include <gtirb/gtirb.hpp>
+
+#include <cstdint>
+#include <map>
+#include <memory_resource>
+#include <optional>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace gtirb_pprint {
+
+/// The AuxData tables read by the pretty printers.
+namespace aux {
+using Comments = std::map<gtirb::Offset, std::string>;
+using CFIDirectives = std::map<
+    gtirb::Offset,
+    std::vector<std::tuple<std::string, std::vector<int64_t>, gtirb::UUID>>>;
+using Encodings = std::map<gtirb::UUID, std::string>;
+using SymbolForwarding = std::map<gtirb::UUID, gtirb::UUID>;
+using ElfSectionProperties =
+    std::map<gtirb::UUID, std::tuple<uint64_t, uint64_t>>;
+} // namespace aux
+
+/// The blocks, data objects and function tables of a module, ordered by
+/// address. An AddressIndex is built once per module and then gives the
+/// PreparedModule of any address range of the module by binary search, so
+/// that preparing every section of a module one at a time costs the same as
+/// preparing the whole module once.
+class DEBLOAT_PRETTYPRINTER_EXPORT_API AddressIndex {
+public:
+  AddressIndex(
+      gtirb::Context& context, gtirb::Module& module,
+      std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+  AddressIndex(const AddressIndex&) = delete;
+  AddressIndex& operator=(const AddressIndex&) = delete;
+
+  gtirb::Context& getContext() const { return context; }
+  gtirb::Module& getModule() const { return module; }
+
+private:
+  friend class PreparedModule;
+
+  /// A block of a function, with the index of the function in
+  /// functionEntryLists.
+  struct FunctionBlock {
+    gtirb::Addr address;
+    size_t function;
+    const gtirb::Block* block;
+  };
+
+  gtirb::Context& context;
+  gtirb::Module& module;
+
+  std::pmr::vector<const gtirb::Block*> blocks;
+  std::pmr::vector<const gtirb::DataObject*> dataObjects;
+  std::pmr::vector<gtirb::Addr> functionEntries;
+  std::pmr::vector<gtirb::Addr> functionLastBlocks;
+  std::pmr::vector<FunctionBlock> functionBlocks;
+  std::pmr::vector<std::pmr::vector<gtirb::Addr>> functionEntryLists;
+};
+
+/// The indices of a module shared by all the printers of the module.
+///
+/// A PreparedModule is built once per module and is immutable afterwards. The
+/// AuxData tables used for printing are looked up (and thereby decoded) by the
+/// constructor, so any number of printers may print from the same
+/// PreparedModule concurrently, as long as the module itself is not modified
+/// while they do.
+///
+/// The indices are allocated from the memory resource given to the
+/// constructor, which must outlive the PreparedModule. An arena can thus
+/// release all the memory of the indices at once. The resource is only used
+/// while constructing: the printers allocate their caches from resources of
+/// their own, so printing concurrently never touches it.
+///
+/// A PreparedModule may also cover only part of a module: an address range,
+/// or some functions. Such a PreparedModule is built without preparing the
+/// rest of the module.
+class DEBLOAT_PRETTYPRINTER_EXPORT_API PreparedModule {
+public:
+  PreparedModule(
+      gtirb::Context& context, gtirb::Module& module,
+      std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+  /// Prepare the part of a module in the address range [start, end): the
+  /// blocks and data objects starting in the range and the blocks of the
+  /// functions in it. The last function entry before the range is kept too,
+  /// so that the start of the range belongs to the same function as when the
+  /// whole module is prepared.
+  ///
+  /// The blocks are found by their addresses alone, and the function tables
+  /// are only resolved for the functions with blocks in the range. To prepare
+  /// many ranges of a module, use an AddressIndex instead.
+  PreparedModule(
+      gtirb::Context& context, gtirb::Module& module, gtirb::Addr start,
+      gtirb::Addr end,
+      std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+  /// Prepare the part of an indexed module in the address range [start,
+  /// end), as the constructor above does. The index must outlive the
+  /// PreparedModule.
+  PreparedModule(
+      const AddressIndex& index, gtirb::Addr start, gtirb::Addr end,
+      std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+  /// Prepare the functions of a module with the given UUIDs, which are keys
+  /// of the "functionBlocks" AuxData table: their blocks, entries and last
+  /// blocks. No data object is prepared.
+  PreparedModule(
+      gtirb::Context& context, gtirb::Module& module,
+      const std::vector<gtirb::UUID>& functionIds,
+      std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+  /// Return the UUIDs of the functions of a module with an entry at a symbol
+  /// of the given name.
+  static std::vector<gtirb::UUID> findFunctions(gtirb::Context& context,
+                                                const gtirb::Module& module,
+                                                const std::string& name);
+
+  PreparedModule(const PreparedModule&) = delete;
+  PreparedModule& operator=(const PreparedModule&) = delete;
+
+  gtirb::Context& getContext() const { return context; }
+  gtirb::Module& getModule() const { return module; }
+  std::pmr::memory_resource* getMemoryResource() const { return resource; }
+
+  /// The addresses of the entry blocks of the functions, from the
+  /// "functionEntries" AuxData table.
+  const std::pmr::set<gtirb::Addr>& getFunctionEntries() const {
+    return functionEntries;
+  }
+
+  /// The addresses of the entry blocks of all the functions of the module,
+  /// in increasing order, even if only part of the module is prepared: the
+  /// function containing an address and the skipped regions depend on the
+  /// entries outside the part too.
+  const std::pmr::vector<gtirb::Addr>& getModuleFunctionEntries() const {
+    return *moduleFunctionEntries;
+  }
+
+  /// The addresses of the last block of each function, from the
+  /// "functionBlocks" AuxData table.
+  const std::pmr::set<gtirb::Addr>& getFunctionLastBlocks() const {
+    return functionLastBlocks;
+  }
+
+  /// A function of the module, from the "functionEntries" and
+  /// "functionBlocks" AuxData tables.
+  struct Function {
+    std::pmr::vector<gtirb::Addr> entries;
+    std::pmr::vector<const gtirb::Block*> blocks;
+  };
+
+  const std::pmr::vector<Function>& getFunctions() const { return functions; }
+
+  /// The blocks of the module, ordered by address.
+  const std::pmr::vector<const gtirb::Block*>& getBlocks() const {
+    return blocks;
+  }
+
+  /// The data objects of the module, ordered by address.
+  const std::pmr::vector<const gtirb::DataObject*>& getDataObjects() const {
+    return dataObjects;
+  }
+
+  /// The AuxData tables of the module, or \c nullptr if absent.
+  /// @{
+  const aux::Comments* getComments() const { return comments; }
+  const aux::CFIDirectives* getCFIDirectives() const { return cfiDirectives; }
+  const aux::Encodings* getEncodings() const { return encodings; }
+  const aux::SymbolForwarding* getSymbolForwarding() const {
+    return symbolForwarding;
+  }
+  const aux::ElfSectionProperties* getElfSectionProperties() const {
+    return elfSectionProperties;
+  }
+  /// @}
+
+private:
+  /// Initialize the members without preparing anything.
+  struct Empty {};
+  PreparedModule(Empty, gtirb::Context& context, gtirb::Module& module,
+                 std::pmr::memory_resource* resource);
+
+  gtirb::Context& context;
+  gtirb::Module& module;
+  std::pmr::memory_resource* resource;
+
+  std::pmr::set<gtirb::Addr> functionEntries;
+  std::pmr::set<gtirb::Addr> functionLastBlocks;
+  /// Either ownModuleFunctionEntries or those of an AddressIndex.
+  const std::pmr::vector<gtirb::Addr>* moduleFunctionEntries;
+  std::pmr::vector<gtirb::Addr> ownModuleFunctionEntries;
+  std::pmr::vector<Function> functions;
+  std::pmr::vector<const gtirb::Block*> blocks;
+  std::pmr::vector<const gtirb::DataObject*> dataObjects;
+
+  const aux::Comments* comments;
+  const aux::CFIDirectives* cfiDirectives;
+  const aux::Encodings* encodings;
+  const aux::SymbolForwarding* symbolForwarding;
+  const aux::ElfSectionProperties* elfSectionProperties;
+};
+
+/// Return the addresses at which a module printed one section at a time is
+/// split: 0, for whatever precedes the first section, then the address of
+/// each section, in increasing order.
+DEBLOAT_PRETTYPRINTER_EXPORT_API std::vector<gtirb::Addr>
+getSectionStarts(const gtirb::Module& module);
+
+} // namespace gtirb_pprint
+
+#endif /* GTIRB_PP_PREPARED_MODULE_H */
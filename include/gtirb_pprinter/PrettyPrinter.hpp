@@ -16,21 +16,29 @@
 #define GTIRB_PP_PRETTY_PRINTER_H
 
 #include "Export.hpp"
+#include "PreparedModule.hpp"
 #include "Syntax.hpp"
 
 #include <gtirb/gtirb.hpp>
 
+#include <algorithm>
 #include <boost/range/any_range.hpp>
 #include <capstone/capstone.h>
 #include <cstdint>
 #include <initializer_list>
 #include <iosfwd>
+#include <iterator>
 #include <list>
 #include <map>
 #include <memory>
+#include <memory_resource>
 #include <optional>
+#include <ostream>
 #include <string>
+#include <string_view>
+#include <tuple>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 /// \brief Pretty-print GTIRB representations.
@@ -39,10 +47,20 @@ namespace gtirb_pprint {
 struct PrintingPolicy;
 class PrettyPrinterFactory;
 class PrettyPrinterBase;
+class SharedDecoder;
+class OperationCache;
+class ChunkGenerator;
 
 /// Whether a pretty printer should include debugging messages in it output.
 enum DebugStyle { NoDebug, DebugMessages };
 
+/// Whether a pretty printer should lay out its output for human readers, or
+/// leave out indentation and decorative comments and shorten padding.
+enum LayoutStyle { ReadableLayout, CompactLayout };
+
+/// A half-open range of addresses [first, second).
+using AddrRange = std::pair<gtirb::Addr, gtirb::Addr>;
+
 /// A range containing strings. These can be standard library containers or
 /// pairs of iterators, for example.
 using string_range = boost::any_range<std::string, boost::forward_traversal_tag,
@@ -52,6 +70,10 @@ using string_range = boost::any_range<std::string, boost::forward_traversal_tag,
 /// used to load a default \link PrintingPolicy and create a pretty printer for
 /// the formats and syntaxes named in the initialization lists.
 ///
+/// The registry may be read from any number of threads without locking:
+/// registering a factory or setting a default syntax publishes a new copy of
+/// the registry, which is cheap because it only happens at startup.
+///
 /// For example, \code registerPrinter({"foo"}, {"bar"}, theFactory);
 /// \endcode
 ///
@@ -79,9 +101,22 @@ void setDefaultSyntax(const std::string& format, const std::string& syntax);
 /// Return the default syntax for a file format.
 std::optional<std::string> getDefaultSyntax(const std::string& format);
 
+/// Return the target to print a module for: \p format, or the file format of
+/// the module if it is empty, and \p syntax, or the default syntax of the
+/// format if it is empty.
+///
+/// \throw std::invalid_argument if no printer is registered for the target.
+std::tuple<std::string, std::string>
+resolveTarget(const gtirb::Module& module, const std::string& format,
+              const std::string& syntax);
+
 /// The primary interface for pretty-printing GTIRB objects. The typical flow
 /// is to create a PrettyPrinter, configure it (e.g., set the output syntax,
 /// enable/disable debugging messages, etc.), then print one or more IR objects.
+///
+/// Once configured, a PrettyPrinter may be used from several threads at once.
+/// To print the same module concurrently (for example, in several syntaxes),
+/// build a single \link PreparedModule and pass it to every print call.
 class PrettyPrinter {
 public:
   /// Construct a PrettyPrinter with the default configuration.
@@ -114,6 +149,17 @@ public:
   /// \c false.
   bool getDebug() const;
 
+  /// Enable or disable the compact layout, for output that is only read by
+  /// the assembler. The assembled code is the same in both layouts.
+  ///
+  /// \param do_compact whether to use the compact layout
+  void setCompact(bool do_compact);
+
+  /// Indicates whether the compact layout is enabled.
+  ///
+  /// \return \c true if the compact layout is enabled, otherwise \c false.
+  bool getCompact() const;
+
   /// Skip the named function when printing.
   ///
   /// \param functionName name of the function to skip
@@ -124,6 +170,15 @@ public:
   /// \param functionName name of the function to keep
   void keepFunction(const std::string& functionName);
 
+  /// Return the printing policy used to print a module: the default policy of
+  /// the target's factory, adjusted with the configured debug style and
+  /// skipped and kept functions.
+  ///
+  /// \param module the module that would be printed
+  ///
+  /// \return the printing policy.
+  PrintingPolicy getPolicy(const gtirb::Module& module) const;
+
   /// Pretty-print the IR module to a stream. The default output target is
   /// deduced from the file format of the IR if it is not explicitly set with
   /// \link setTarget.
@@ -131,18 +186,154 @@ public:
   /// \param stream  the stream to print to
   /// \param context context to use for allocating AuxData objects if needed
   /// \param module      the module to pretty-print
+  /// \param resource    the memory resource from which the indices of the
+  ///                    module and the caches of the printer are allocated
   ///
   /// \return a condition indicating if there was an error, or condition 0 if
   /// there were no errors.
   std::error_condition print(std::ostream& stream, gtirb::Context& context,
-                             gtirb::Module& module) const;
+                             gtirb::Module& module,
+                             std::pmr::memory_resource* resource =
+                                 std::pmr::get_default_resource()) const;
+
+  /// The default size of the output buffer of \link printStreaming.
+  static constexpr std::size_t DefaultStreamingBufferSize = 1 << 20;
+
+  /// Pretty-print the IR module to a stream one section at a time, in
+  /// address order, so that the memory used does not grow with the size of
+  /// the module, apart from an \link AddressIndex of the module. The indices
+  /// of a section are only built, from the AddressIndex, when the section is
+  /// reached, and released once it is printed. The output goes through a
+  /// buffer of \p bufferSize bytes, written to the stream whenever it is full
+  /// and at the end of each section. The output is the same as with \link
+  /// print.
+  ///
+  /// \param stream     the stream to print to
+  /// \param context    context to use for allocating AuxData objects if needed
+  /// \param module     the module to pretty-print
+  /// \param bufferSize the size of the output buffer
+  ///
+  /// \return a condition indicating if there was an error, or condition 0 if
+  /// there were no errors.
+  std::error_condition
+  printStreaming(std::ostream& stream, gtirb::Context& context,
+                 gtirb::Module& module,
+                 std::size_t bufferSize = DefaultStreamingBufferSize) const;
+
+  /// Pretty-print a prepared module to a stream. This may be called
+  /// concurrently with other calls printing the same prepared module.
+  ///
+  /// \param stream   the stream to print to
+  /// \param prepared the module to pretty-print, with its indices
+  /// \param resource the upstream resource of the pool from which the caches
+  ///                 of the printer are allocated, which must be thread-safe
+  ///                 if other calls use it concurrently
+  ///
+  /// \return a condition indicating if there was an error, or condition 0 if
+  /// there were no errors.
+  std::error_condition print(std::ostream& stream,
+                             const PreparedModule& prepared,
+                             std::pmr::memory_resource* resource =
+                                 std::pmr::get_default_resource()) const;
+
+  /// A target (format and syntax) and the stream to print it to.
+  using TargetStream =
+      std::pair<std::tuple<std::string, std::string>, std::ostream*>;
+
+  /// Pretty-print a prepared module for several targets at once. The module
+  /// is traversed once and each block is disassembled once for all the
+  /// targets, which is much cheaper than printing each target separately.
+  /// The configured target is ignored. It is the caller's responsibility to
+  /// ensure that the targets have been registered.
+  ///
+  /// \param targets  the targets to print and their streams
+  /// \param prepared the module to pretty-print, with its indices
+  ///
+  /// \return a condition indicating if there was an error, or condition 0 if
+  /// there were no errors.
+  std::error_condition print(const std::vector<TargetStream>& targets,
+                             const PreparedModule& prepared) const;
+
+  /// Create a generator producing the assembly of a prepared module one chunk
+  /// at a time, on demand. Nothing is printed until chunks are requested.
+  ///
+  /// \param prepared the module to pretty-print, which must outlive the
+  ///                 generator
+  ///
+  /// \return the generator, positioned at the start of the module.
+  ChunkGenerator generate(const PreparedModule& prepared) const;
+
+  /// Create a generator producing the assembly of a module one chunk at a
+  /// time, on demand, that prepares the module one section at a time. Only
+  /// the section of the first element produced, which \link
+  /// ChunkGenerator::seek selects, is prepared before the first chunk.
+  ///
+  /// \param context the context of the module
+  /// \param module  the module to pretty-print, which must outlive the
+  ///                generator
+  ///
+  /// \return the generator, positioned at the start of the module.
+  ChunkGenerator generate(gtirb::Context& context,
+                          gtirb::Module& module) const;
+
+  /// Pretty-print a single function of a prepared module: the blocks listed
+  /// for it in the "functionBlocks" AuxData table, in the context of their
+  /// sections. Only the selected blocks are visited. The function is printed
+  /// even if it is skipped by default.
+  ///
+  /// \param stream   the stream to print to
+  /// \param prepared the module containing the function, which may be
+  ///                 prepared for the function alone with the UUIDs from
+  ///                 \link PreparedModule::findFunctions
+  /// \param name     the name of a symbol at an entry of the function
+  ///
+  /// \return \c std::errc::invalid_argument if no such function exists,
+  /// condition 0 otherwise.
+  std::error_condition printFunction(std::ostream& stream,
+                                     const PreparedModule& prepared,
+                                     const std::string& name) const;
+
+  /// Pretty-print the blocks and data objects of a prepared module that start
+  /// in the address range [start, end), in the context of their sections.
+  /// Only the selected blocks and data objects are visited.
+  ///
+  /// \param stream   the stream to print to
+  /// \param prepared the module to pretty-print, which may be prepared for
+  ///                 the range alone
+  /// \param start    the first address of the range
+  /// \param end      the address past the end of the range
+  ///
+  /// \return a condition indicating if there was an error, or condition 0 if
+  /// there were no errors.
+  std::error_condition printRange(std::ostream& stream,
+                                  const PreparedModule& prepared,
+                                  gtirb::Addr start, gtirb::Addr end) const;
+
+  /// Create the printer of the configured target for a prepared module, with
+  /// the configured policy, for callers that need its view of the module,
+  /// such as the names and skipped ranges of its functions.
+  ///
+  /// \param prepared the module to print, which must outlive the printer
+  /// \param resource the resource of the caches of the printer, which must
+  ///                 outlive it
+  ///
+  /// \return the printer.
+  std::unique_ptr<PrettyPrinterBase>
+  makePrinter(const PreparedModule& prepared,
+              std::pmr::memory_resource* resource =
+                  std::pmr::get_default_resource()) const;
 
 private:
+  std::shared_ptr<PrettyPrinterFactory>
+  getFactory(const gtirb::Module& module) const;
+  PrintingPolicy getPolicy(const PrettyPrinterFactory& factory) const;
+
   std::set<std::string> m_skip_funcs;
   std::set<std::string> m_keep_funcs;
   std::string m_format;
   std::string m_syntax;
   DebugStyle m_debug;
+  LayoutStyle m_layout = ReadableLayout;
 };
 
 struct PrintingPolicy {
@@ -158,6 +349,8 @@ struct PrintingPolicy {
   std::unordered_set<std::string> arraySections;
 
   DebugStyle debug = NoDebug;
+
+  LayoutStyle layout = ReadableLayout;
 };
 
 /// Abstract factory - encloses default printing configuration and a method for
@@ -169,22 +362,141 @@ public:
   /// Load the default printing policy.
   virtual const PrintingPolicy& defaultPrintingPolicy() const = 0;
 
-  /// Create the pretty printer instance.
+  /// Create the pretty printer instance. The prepared module must outlive the
+  /// printer. The printer allocates its caches and scratch buffers from \p
+  /// resource, which must outlive it too, and which the printer may use
+  /// without synchronization: give each printer that runs concurrently with
+  /// others a resource of its own.
   virtual std::unique_ptr<PrettyPrinterBase>
-  create(gtirb::Context& context, gtirb::Module& module,
-         const PrintingPolicy& policy) = 0;
+  create(const PreparedModule& prepared, const PrintingPolicy& policy,
+         std::pmr::memory_resource* resource) = 0;
+};
+
+/// A Capstone handle for x86-64, with detail on, borrowed from a pool shared
+/// by all the printers and returned to it on destruction. Opening and
+/// configuring a handle is much more expensive than the rest of a printer's
+/// construction, so a pooled handle makes printing small modules cheap.
+///
+/// A borrowed handle is used by a single object at a time and may be used
+/// from any thread. Its options other than CS_OPT_DETAIL must not be changed,
+/// and CS_OPT_DETAIL must be on again before the handle is returned.
+class DEBLOAT_PRETTYPRINTER_EXPORT_API CapstoneHandle {
+public:
+  /// Borrow a handle with the given CS_OPT_SYNTAX value.
+  explicit CapstoneHandle(cs_opt_value syntax = CS_OPT_SYNTAX_DEFAULT);
+
+  CapstoneHandle(const CapstoneHandle&) = delete;
+  CapstoneHandle(CapstoneHandle&& other) noexcept;
+  CapstoneHandle& operator=(const CapstoneHandle&) = delete;
+  CapstoneHandle& operator=(CapstoneHandle&& other) noexcept;
+  ~CapstoneHandle();
+
+  operator csh() const { return handle; }
+
+  /// The CS_OPT_SYNTAX value of the handle.
+  cs_opt_value getSyntax() const { return syntax; }
+
+private:
+  cs_opt_value syntax;
+  csh handle = 0;
+};
+
+/// Instructions disassembled by Capstone. The instructions are either owned,
+/// and freed on destruction, borrowed from another DecodedInstructions, or
+/// copied from another DecodedInstructions to be modified.
+class DEBLOAT_PRETTYPRINTER_EXPORT_API DecodedInstructions {
+public:
+  DecodedInstructions() = default;
+
+  /// Take ownership of instructions returned by cs_disasm.
+  DecodedInstructions(cs_insn* insn_, size_t count_)
+      : insn(insn_), count(count_), owned(true) {}
+
+  DecodedInstructions(const DecodedInstructions&) = delete;
+  DecodedInstructions(DecodedInstructions&& other) noexcept;
+  DecodedInstructions& operator=(const DecodedInstructions&) = delete;
+  DecodedInstructions& operator=(DecodedInstructions&& other) noexcept;
+  ~DecodedInstructions();
+
+  /// Disassemble a block with the current options of a Capstone handle.
+  static DecodedInstructions decode(csh handle, const gtirb::Module& module,
+                                    const gtirb::Block& block);
+
+  /// Refer to the instructions of another object, which must outlive this
+  /// one.
+  static DecodedInstructions borrow(const DecodedInstructions& other);
+
+  size_t size() const { return count; }
+  const cs_insn& operator[](size_t i) const { return insn[i]; }
+
+  /// Copy the instructions of another object and their details.
+  static DecodedInstructions copy(const DecodedInstructions& other);
+
+  /// Return an instruction of a copy, whose detail may be modified too.
+  cs_insn& modify(size_t i);
+
+private:
+  cs_insn* insn = nullptr;
+  size_t count = 0;
+  bool owned = false;
+  /// The instructions and details of a copy.
+  std::vector<cs_insn> copies;
+  std::vector<cs_detail> details;
 };
 
 /// The pretty-printer interface. There is only one exposed function, \link
 /// print().
 class PrettyPrinterBase {
 public:
-  PrettyPrinterBase(gtirb::Context& context, gtirb::Module& module,
-                    const Syntax& syntax, const PrintingPolicy& policy);
+  PrettyPrinterBase(
+      const PreparedModule& prepared, const Syntax& syntax,
+      const PrintingPolicy& policy,
+      std::pmr::memory_resource* resource = std::pmr::get_default_resource());
   virtual ~PrettyPrinterBase();
 
   virtual std::ostream& print(std::ostream& out);
 
+  /// Print the same module with several printers in a single traversal of the
+  /// module. Each block is disassembled once (see \link adaptInstructions).
+  ///
+  /// \param printers the printers and the stream each one prints to
+  /// \param ranges   if given, only the blocks and data objects starting in
+  ///                 these address ranges are printed
+  static void
+  printAll(const std::vector<std::pair<PrettyPrinterBase*, std::ostream*>>&
+               printers,
+           std::optional<std::vector<AddrRange>> ranges = std::nullopt);
+
+  /// Print the part of a module covered by the prepared module, continuing
+  /// the output of the printer of the previous part. The parts of a module
+  /// must be printed in address order, each printer starting from where the
+  /// previous one stopped.
+  ///
+  /// \param os    the stream to print to
+  /// \param last  the address past the last element printed before
+  /// \param first whether this is the first part, preceded by the file header
+  /// \param final whether this is the last part, followed by the file footer
+  ///
+  /// \return the address past the last element printed.
+  gtirb::Addr printPart(std::ostream& os, gtirb::Addr last, bool first,
+                        bool final);
+
+  /// The sorted, disjoint address ranges of the skipped sections and
+  /// functions of the whole module, even if only part of it is prepared. A
+  /// function extends to the next function entry of the module. They are
+  /// built on first use, since subclasses may change the policy in their
+  /// constructors.
+  std::shared_ptr<const std::vector<AddrRange>> getSkippedRanges() const;
+
+  /// Use the skipped ranges of another printer of the same module with the
+  /// same policy, such as the printer of another part of the module, instead
+  /// of building them again.
+  void setSkippedRanges(std::shared_ptr<const std::vector<AddrRange>> ranges);
+
+  /// The name of the function entered at an address, as printed in its
+  /// header and .globl directive.
+  virtual std::string getFunctionName(gtirb::Addr x) const;
+
 protected:
   const Syntax& syntax;
   PrintingPolicy policy;
@@ -197,6 +509,10 @@ protected:
 
   virtual std::string getRegisterName(unsigned int reg) const;
 
+  /// The name of a register as formatted by getRegisterName(), from a table
+  /// built on first use.
+  std::string_view registerName(unsigned int reg);
+
   virtual void printBar(std::ostream& os, bool heavy = true);
   virtual void printHeader(std::ostream& os) = 0;
   virtual void printFooter(std::ostream& os) = 0;
@@ -214,6 +530,16 @@ protected:
   virtual void printFunctionHeader(std::ostream& os, gtirb::Addr addr) = 0;
   virtual void printFunctionFooter(std::ostream& os, gtirb::Addr addr) = 0;
 
+  /// Print what precedes an element starting at \p nextAddr when the previous
+  /// element ended at \p last: the symbols defined at \p last and the section
+  /// footer and header if the section changes. If the element overlaps the
+  /// previous one, print a warning instead and return \c false.
+  bool printElementPrologue(std::ostream& os, gtirb::Addr nextAddr,
+                            gtirb::Addr last);
+
+  /// Print what follows the last element, which ended at \p last.
+  void printModuleEnd(std::ostream& os, gtirb::Addr last);
+
   /// Print the block as long as it does not overlap with the address last.
   /// If it overlaps, print a warning instead.
   /// Return the ending address of the block if this was printed. Otherwise
@@ -230,6 +556,22 @@ protected:
                                                gtirb::Addr last);
 
   virtual void printBlock(std::ostream& os, const gtirb::Block& x);
+
+  /// Print the instructions of a block, without its function header.
+  void printBlockContents(std::ostream& os, const gtirb::Block& x);
+
+  /// Disassemble the instructions of a block with this printer's options.
+  /// The instructions are decoded without details, which printInstruction()
+  /// only decodes for the instructions it cannot print from its cache.
+  virtual DecodedInstructions decodeBlock(const gtirb::Block& x);
+
+  /// Derive this printer's instructions for a block from the instructions
+  /// decoded once with detail in Capstone's default (Intel) syntax, when
+  /// printing several syntaxes at once. The default implementation uses them
+  /// as they are if this printer's handle has the default syntax, and calls
+  /// \link decodeBlock otherwise.
+  virtual DecodedInstructions
+  adaptInstructions(const gtirb::Block& x, const DecodedInstructions& shared);
   virtual void printDataObject(std::ostream& os,
                                const gtirb::DataObject& dataObject);
   virtual void printNonZeroDataObject(std::ostream& os,
@@ -250,6 +592,10 @@ protected:
   virtual void printInstruction(std::ostream& os, const cs_insn& inst,
                                 const gtirb::Offset& offset);
 
+  /// Print the mnemonic and the operands of an instruction decoded with
+  /// details.
+  virtual void printOperation(std::ostream& os, const cs_insn& inst);
+
   virtual void printEA(std::ostream& os, gtirb::Addr ea);
   virtual void printOperandList(std::ostream& os, const cs_insn& inst);
   virtual void printComments(std::ostream& os, const gtirb::Offset& offset,
@@ -277,6 +623,61 @@ protected:
 
   virtual void printOperand(std::ostream& os, const cs_insn& inst,
                             uint64_t index);
+
+  /// The number of operands of an instruction that are printed, which
+  /// excludes the implicit operands of string instructions.
+  static uint8_t getPrintedOperandCount(const cs_insn& inst);
+
+  /// The symbolic expression of an immediate or memory operand, if any.
+  const gtirb::SymbolicExpression*
+  getSymbolicOperand(const cs_insn& inst, const cs_x86_op& op) const;
+
+  /// Print the indented mnemonic of an instruction, which printOperation()
+  /// follows with the operand list.
+  void printMnemonic(std::ostream& os, const cs_insn& inst);
+
+  /// The body of printOperandList(), which prints each operand with
+  /// \p printOperand(os, inst, index). printOperandList() passes the virtual
+  /// printOperand(); StaticPrettyPrinter passes its own, called statically.
+  template <class PrintOperand>
+  static void printOperandsWith(std::ostream& os, const cs_insn& inst,
+                                PrintOperand&& printOperand) {
+    uint8_t opCount = getPrintedOperandCount(inst);
+    for (uint8_t i = 0; i < opCount; ++i) {
+      if (i != 0)
+        os << ',';
+      printOperand(os, inst, i);
+    }
+  }
+
+  /// The body of printOperand(), which prints the operand with the printer
+  /// for its type, called like printOpRegdirect(), printOpImmediate() and
+  /// printOpIndirect() respectively.
+  template <class PrintRegdirect, class PrintImmediate, class PrintIndirect>
+  void printOperandWith(std::ostream& os, const cs_insn& inst, uint64_t index,
+                        PrintRegdirect&& printRegdirect,
+                        PrintImmediate&& printImmediate,
+                        PrintIndirect&& printIndirect) {
+    const cs_x86_op& op = inst.detail->x86.operands[index];
+    switch (op.type) {
+    case X86_OP_REG:
+      printRegdirect(os, inst, op);
+      return;
+    case X86_OP_IMM:
+      printImmediate(os, getSymbolicOperand(inst, op), inst, index);
+      return;
+    case X86_OP_MEM:
+      printIndirect(os, getSymbolicOperand(inst, op), inst, index);
+      return;
+    case X86_OP_INVALID:
+      break;
+    }
+    invalidOperand();
+  }
+
+  /// Report an operand that Capstone could not decode and exit.
+  [[noreturn]] static void invalidOperand();
+
   virtual void printOpRegdirect(std::ostream& os, const cs_insn& inst,
                                 const cs_x86_op& op) = 0;
   virtual void printOpImmediate(std::ostream& os,
@@ -296,8 +697,32 @@ protected:
   shouldExcludeDataElement(const gtirb::Section& section,
                            const gtirb::DataObject& dataObject) const;
 
+  /// Whether the element at an address is in a skipped section or function.
+  /// The skipped address ranges are resolved from the policy on first use.
   bool skipEA(const gtirb::Addr x) const;
 
+  /// If the element at \p addr is skipped, the end of the skipped region it
+  /// starts: every element starting before the end is skipped too and none
+  /// of them starts a section, so the printing loops jump over them.
+  std::optional<gtirb::Addr> getSkippedRegionEnd(gtirb::Addr addr) const;
+
+  /// Advance \p it over the elements starting before \p end, and return the
+  /// end of the last of them, or \p last if there is none.
+  template <class It>
+  static gtirb::Addr skipElements(It& it, It itEnd, gtirb::Addr end,
+                                  gtirb::Addr last) {
+    It next = std::lower_bound(
+        it, itEnd, end, [](const auto* x, gtirb::Addr a) {
+          return x->getAddress() < a;
+        });
+    if (next != it) {
+      const auto* lastSkipped = *std::prev(next);
+      last = std::max(last, lastSkipped->getAddress() + lastSkipped->getSize());
+    }
+    it = next;
+    return last;
+  }
+
   // This method assumes sections do not overlap
   const std::optional<const gtirb::Section*>
   getContainerSection(const gtirb::Addr addr) const;
@@ -325,14 +750,22 @@ protected:
 
   bool isSectionSkipped(const std::string& name);
 
-  csh csHandle;
+  /// Disassembles in Capstone's default (Intel) syntax unless a subclass
+  /// replaces it with a handle for another syntax.
+  CapstoneHandle csHandle;
 
   bool debug;
+  bool compact;
+
+  /// The indentation of instructions and data directives.
+  const std::string& indent() const;
 
+  const PreparedModule& prepared;
+  /// The resource of the caches and scratch buffers of this printer.
+  std::pmr::memory_resource* resource;
   gtirb::Context& context;
   gtirb::Module& module;
 
-  virtual std::string getFunctionName(gtirb::Addr x) const;
   virtual std::string getSymbolName(gtirb::Addr x) const;
   virtual std::optional<std::string>
   getForwardedSymbolName(const gtirb::Symbol* symbol, bool inData) const;
@@ -340,11 +773,37 @@ protected:
   bool isAmbiguousSymbol(const std::string& ea) const;
 
 private:
-  std::set<gtirb::Addr> functionEntry;
-  std::set<gtirb::Addr> functionLastBlock;
+  friend class ChunkGenerator;
+
+  /// Set while printing several syntaxes at once.
+  SharedDecoder* sharedDecoder = nullptr;
+
+  /// The operations printed for instructions whose text only depends on
+  /// their bytes.
+  std::unique_ptr<OperationCache> operationCache;
+
+  /// The formatted register names, indexed by Capstone register.
+  std::pmr::vector<std::pmr::string> registerNames;
+
+  /// See getSkippedRanges(). They may outlive the printer, so they are not
+  /// allocated from its resource.
+  mutable std::shared_ptr<const std::vector<AddrRange>> skippedRanges;
+
+  /// Print the operation of an instruction decoded without details, from the
+  /// cache if possible: only instructions that are not cached yet, relative
+  /// branches and instructions with symbolic operands are decoded again.
+  void printOperationWithoutDetail(std::ostream& os, const cs_insn& inst);
+
+  /// When printing selected address ranges, the address of the first element
+  /// of the current range, whose section header is printed even if the
+  /// section does not start there.
+  std::optional<gtirb::Addr> rangeStart;
 
   std::string getForwardedSymbolEnding(const gtirb::Symbol* symbol,
                                        bool inData) const;
+  /// The symbol a symbol is forwarded to, from the "symbolForwarding"
+  /// AuxData table, or null if it is not forwarded.
+  const gtirb::Symbol* getForwardedSymbol(const gtirb::Symbol* symbol) const;
 };
 
 } // namespace gtirb_pprint
@@ -0,0 +1,70 @@
+//===- StaticPrettyPrinter.hpp ------------------------------------ C++ -*-===//
+//
+//  Copyright (C) 2019 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GTIRB_PP_STATIC_PRINTER_H
+#define GTIRB_PP_STATIC_PRINTER_H
+
+#include "PrettyPrinter.hpp"
+
+namespace gtirb_pprint {
+
+/// A built-in printer whose operations and operands are printed without
+/// virtual calls. From the call to printOperation() on, the steps are called
+/// by their qualified names, and the class is final, so the compiler can
+/// inline the operand printers of \p Printer into the loop over the
+/// operands. The built-in factories create these; \p Printer itself remains
+/// the extension point for printers derived from it.
+///
+/// The member functions are instantiated once, in the source file of
+/// \p Printer, where its operand printers are defined.
+template <class Printer> class StaticPrettyPrinter final : public Printer {
+public:
+  using Printer::Printer;
+
+protected:
+  void printOperation(std::ostream& os, const cs_insn& inst) override {
+    this->printMnemonic(os, inst);
+    StaticPrettyPrinter::printOperandList(os, inst);
+  }
+
+  void printOperandList(std::ostream& os, const cs_insn& inst) override {
+    this->printOperandsWith(os, inst,
+                            [this](std::ostream& os_, const cs_insn& inst_,
+                                   uint64_t index) {
+                              StaticPrettyPrinter::printOperand(os_, inst_,
+                                                                index);
+                            });
+  }
+
+  void printOperand(std::ostream& os, const cs_insn& inst,
+                    uint64_t index) override {
+    this->printOperandWith(
+        os, inst, index,
+        [this](std::ostream& os_, const cs_insn& inst_, const cs_x86_op& op) {
+          Printer::printOpRegdirect(os_, inst_, op);
+        },
+        [this](std::ostream& os_, const gtirb::SymbolicExpression* symbolic,
+               const cs_insn& inst_, uint64_t index_) {
+          Printer::printOpImmediate(os_, symbolic, inst_, index_);
+        },
+        [this](std::ostream& os_, const gtirb::SymbolicExpression* symbolic,
+               const cs_insn& inst_, uint64_t index_) {
+          Printer::printOpIndirect(os_, symbolic, inst_, index_);
+        });
+  }
+};
+
+} // namespace gtirb_pprint
+
+#endif /* GTIRB_PP_STATIC_PRINTER_H */
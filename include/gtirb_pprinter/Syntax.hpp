@@ -15,8 +15,10 @@
 #ifndef GTIRB_PP_SYNTAX_H
 #define GTIRB_PP_SYNTAX_H
 
+#include <iosfwd>
 #include <optional>
 #include <string>
+#include <string_view>
 
 namespace gtirb_pprint {
 
@@ -35,6 +37,7 @@ public:
 
   // Directives
   virtual const std::string& nop() const { return NopDirective; }
+  virtual const std::string& fill() const { return FillDirective; }
   virtual const std::string& zeroByte() const { return ZeroByteDirective; }
   virtual const std::string& string() const = 0;
 
@@ -56,13 +59,17 @@ public:
   virtual std::string formatFunctionName(const std::string& x) const;
   virtual std::string formatSymbolName(const std::string& x) const;
   virtual std::string avoidRegNameConflicts(const std::string& x) const;
+  /// Write a symbol name as formatSymbolName() formats it, without copying
+  /// it. Override it along with formatSymbolName().
+  virtual void writeSymbolName(std::ostream& os, const std::string& x) const;
 
-  virtual std::optional<std::string> getSizeName(uint64_t bits) const;
+  virtual std::optional<std::string_view> getSizeName(uint64_t bits) const;
 
 protected:
   std::string TabStyle{"          "};
 
   std::string NopDirective{"nop"};
+  std::string FillDirective{".fill"};
   std::string ZeroByteDirective{".byte 0x00"};
 
   std::string TextSection{".text"};
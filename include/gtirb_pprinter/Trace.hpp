@@ -0,0 +1,86 @@
+//===- Trace.hpp ------------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2019 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GTIRB_PP_TRACE_H
+#define GTIRB_PP_TRACE_H
+
+#include "Export.hpp"
+
+#include <chrono>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+
+namespace gtirb_pprint {
+
+/// Timelines of the work done by every thread, in the Chrome trace event
+/// format read by chrome://tracing and Perfetto.
+///
+/// Spans are recorded only between start() and write(); otherwise they cost
+/// a single check.
+namespace trace {
+
+/// Start recording the spans of every thread, forgetting any recorded before.
+DEBLOAT_PRETTYPRINTER_EXPORT_API void start();
+
+/// Whether spans are being recorded.
+DEBLOAT_PRETTYPRINTER_EXPORT_API bool recording();
+
+/// Stop recording and write the recorded spans as a JSON trace. Return
+/// \c false if the stream failed.
+DEBLOAT_PRETTYPRINTER_EXPORT_API bool write(std::ostream& os);
+
+/// Record the time between its construction and its destruction on the
+/// current thread.
+///
+/// For example, \code
+/// trace::Span span("io", "load IR", path);
+/// \endcode
+class DEBLOAT_PRETTYPRINTER_EXPORT_API Span {
+public:
+  /// \param category the kind of work, e.g. "print", "io" or "process"
+  /// \param name     what is done
+  /// \param detail   what it is done on, e.g. a module or a file name
+  Span(const char* category, std::string_view name,
+       std::string_view detail = {});
+  ~Span();
+
+  Span(const Span&) = delete;
+  Span& operator=(const Span&) = delete;
+
+private:
+  const char* category;
+  std::string name;
+  std::string detail;
+  std::chrono::steady_clock::time_point begin;
+  bool active;
+};
+
+/// Record spans while alive, and write them to a file when destroyed.
+class DEBLOAT_PRETTYPRINTER_EXPORT_API TraceFile {
+public:
+  explicit TraceFile(std::string path_);
+  ~TraceFile();
+
+  TraceFile(const TraceFile&) = delete;
+  TraceFile& operator=(const TraceFile&) = delete;
+
+private:
+  std::string path;
+};
+
+} // namespace trace
+} // namespace gtirb_pprint
+
+#endif /* GTIRB_PP_TRACE_H */
@@ -0,0 +1,40 @@
+//===- file_utils.hpp -------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2019 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GTIRB_PP_FILE_UTILS_H
+#define GTIRB_PP_FILE_UTILS_H
+
+#include <fstream>
+#include <string>
+
+namespace gtirb_bprint {
+
+/// Auxiliary class to make sure we delete temporary files at the end
+class TempFile {
+public:
+  std::string name;
+  std::ofstream fileStream;
+
+  /// Create and open a new temporary file.
+  ///
+  /// \param extension the file name extension, including the leading dot
+  /// \param mode      the mode used to open the file stream
+  TempFile(const std::string& extension = ".s",
+           std::ios_base::openmode mode = std::ios_base::out);
+  ~TempFile();
+};
+
+} // namespace gtirb_bprint
+
+#endif /* GTIRB_PP_FILE_UTILS_H */
@@ -15,9 +15,14 @@
 #ifndef GTIRB_PP_STRING_UTILS_H
 #define GTIRB_PP_STRING_UTILS_H
 
+#include <iosfwd>
 #include <string>
+#include <string_view>
 
 std::string ascii_str_tolower(std::string s);
 std::string ascii_str_toupper(std::string s);
 
+/// Write \p s in lower case to \p os without allocating.
+void write_ascii_lower(std::ostream& os, std::string_view s);
+
 #endif /* GTIRB_PP_STRING_UTILS_H */
@@ -0,0 +1,149 @@
+//===- gtirb_pprinter_python.cpp --------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2019 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+//
+// The gtirb_pprinter Python module: loads an IR once and prints its modules
+// in the calling process, without holding the GIL while printing.
+//
+//===----------------------------------------------------------------------===//
+#include "PrettyPrinter.hpp"
+
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace py = pybind11;
+
+namespace {
+
+/// An IR with the prepared modules shared by all the prints of the IR, which
+/// may run concurrently.
+class LoadedIR {
+public:
+  explicit LoadedIR(const std::string& path) {
+    std::ifstream in(path, std::ios::in | std::ios::binary);
+    if (!in)
+      throw std::invalid_argument("IR not found: " + path);
+    ir = gtirb::IR::load(context, in);
+    if (!ir)
+      throw std::runtime_error("could not load IR: " + path);
+    for (gtirb::Module& m : ir->modules())
+      modules.push_back(
+          std::make_unique<gtirb_pprint::PreparedModule>(context, m));
+  }
+
+  std::size_t moduleCount() const { return modules.size(); }
+
+  const gtirb_pprint::PreparedModule& getModule(int index) const {
+    if (index < 0 || static_cast<std::size_t>(index) >= modules.size())
+      throw py::index_error("the IR has no module with index " +
+                            std::to_string(index));
+    return *modules[index];
+  }
+
+private:
+  gtirb::Context context;
+  gtirb::IR* ir = nullptr;
+  std::vector<std::unique_ptr<gtirb_pprint::PreparedModule>> modules;
+};
+
+/// Printed assembly code. Python reads it through the buffer protocol, so
+/// memoryview(assembly) does not copy it.
+struct Assembly {
+  std::string text;
+};
+
+Assembly print(const LoadedIR& loaded, int index,
+               const std::optional<std::string>& format,
+               const std::optional<std::string>& syntax, bool debug,
+               bool compact, const std::vector<std::string>& skipFunctions,
+               const std::vector<std::string>& keepFunctions,
+               const std::optional<std::string>& function) {
+  const gtirb_pprint::PreparedModule& prepared = loaded.getModule(index);
+
+  gtirb_pprint::PrettyPrinter pp;
+  pp.setDebug(debug);
+  pp.setCompact(compact);
+  pp.setTarget(gtirb_pprint::resolveTarget(
+      prepared.getModule(), format.value_or(""), syntax.value_or("")));
+  for (const auto& keep : keepFunctions)
+    pp.keepFunction(keep);
+  for (const auto& skip : skipFunctions)
+    pp.skipFunction(skip);
+
+  Assembly assembly;
+  py::gil_scoped_release release;
+  std::ostringstream os;
+  if (function) {
+    if (pp.printFunction(os, prepared, *function))
+      throw std::invalid_argument("no function named '" + *function + "'");
+  } else {
+    pp.print(os, prepared);
+  }
+  assembly.text = os.str();
+  return assembly;
+}
+
+} // namespace
+
+PYBIND11_MODULE(gtirb_pprinter, m) {
+  m.doc() = "Print GTIRB modules as assembly code.";
+
+  m.def("targets", &gtirb_pprint::getRegisteredTargets,
+        "Return the supported (format, syntax) pairs.");
+
+  py::class_<Assembly>(m, "Assembly", py::buffer_protocol(),
+                       "Printed assembly code, readable as a bytes-like "
+                       "object without copying it.")
+      .def_buffer([](Assembly& assembly) {
+        return py::buffer_info(assembly.text.data(), 1,
+                               py::format_descriptor<uint8_t>::format(), 1,
+                               {assembly.text.size()}, {1}, true);
+      })
+      .def("__len__",
+           [](const Assembly& assembly) { return assembly.text.size(); })
+      .def("__bytes__",
+           [](const Assembly& assembly) { return py::bytes(assembly.text); })
+      .def("__str__",
+           [](const Assembly& assembly) { return py::str(assembly.text); });
+
+  py::class_<LoadedIR>(m, "IR",
+                       "A GTIRB file loaded once and printed any number of "
+                       "times, from any number of threads.")
+      .def(py::init([](const std::string& path) {
+             py::gil_scoped_release release;
+             return std::make_unique<LoadedIR>(path);
+           }),
+           py::arg("path"), "Load the IR stored in a file.")
+      .def_property_readonly("module_count", &LoadedIR::moduleCount,
+                             "The number of modules of the IR.")
+      .def("print", &print, py::arg("module") = 0,
+           py::arg("format") = std::nullopt, py::arg("syntax") = std::nullopt,
+           py::arg("debug") = false, py::arg("compact") = false,
+           py::arg("skip_functions") = std::vector<std::string>(),
+           py::arg("keep_functions") = std::vector<std::string>(),
+           py::arg("function") = std::nullopt,
+           "Print a module, or only one of its functions, like the "
+           "gtirb-pprinter options of the same names. The format and syntax "
+           "default to those of the module. The GIL is released while "
+           "printing, so modules can be printed from several threads at "
+           "once.");
+}
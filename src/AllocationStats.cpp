@@ -0,0 +1,156 @@
+//===- AllocationStats.cpp --------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2019 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+#include "AllocationStats.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+#include <ostream>
+
+namespace gtirb_pprint {
+namespace allocation_stats {
+
+namespace {
+constexpr size_t PhaseCount = static_cast<size_t>(Phase::Count);
+
+const char* phaseName(Phase phase) {
+  switch (phase) {
+  case Phase::Other:
+    return "other";
+  case Phase::Setup:
+    return "setup";
+  case Phase::FileHeader:
+    return "file header";
+  case Phase::SectionHeader:
+    return "section header";
+  case Phase::Block:
+    return "block";
+  case Phase::Instruction:
+    return "instruction";
+  case Phase::DataObject:
+    return "data object";
+  case Phase::SymbolReference:
+    return "symbol reference";
+  case Phase::Count:
+    break;
+  }
+  return "";
+}
+
+#ifdef GTIRB_PPRINTER_ALLOCATION_STATS
+struct AtomicCounters {
+  std::atomic<uint64_t> elements{0};
+  std::atomic<uint64_t> allocations{0};
+  std::atomic<uint64_t> bytes{0};
+};
+
+// Zero-initialized before any dynamic initialization, so allocations made
+// during static initialization are counted too.
+std::array<AtomicCounters, PhaseCount> counters;
+thread_local Phase currentPhase = Phase::Other;
+
+AtomicCounters& countersOf(Phase phase) {
+  return counters[static_cast<size_t>(phase)];
+}
+#endif // GTIRB_PPRINTER_ALLOCATION_STATS
+} // namespace
+
+#ifdef GTIRB_PPRINTER_ALLOCATION_STATS
+bool enabled() { return true; }
+
+Counters get(Phase phase) {
+  const AtomicCounters& c = countersOf(phase);
+  return Counters{c.elements.load(std::memory_order_relaxed),
+                  c.allocations.load(std::memory_order_relaxed),
+                  c.bytes.load(std::memory_order_relaxed)};
+}
+
+void reset() {
+  for (AtomicCounters& c : counters) {
+    c.elements.store(0, std::memory_order_relaxed);
+    c.allocations.store(0, std::memory_order_relaxed);
+    c.bytes.store(0, std::memory_order_relaxed);
+  }
+}
+
+Scope::Scope(Phase phase) : previous(currentPhase) {
+  currentPhase = phase;
+  countersOf(phase).elements.fetch_add(1, std::memory_order_relaxed);
+}
+
+Scope::~Scope() { currentPhase = previous; }
+#else
+bool enabled() { return false; }
+
+Counters get(Phase) { return Counters{}; }
+
+void reset() {}
+#endif // GTIRB_PPRINTER_ALLOCATION_STATS
+
+void report(std::ostream& os) {
+  if (!enabled()) {
+    os << "allocations are not counted: configure the library with "
+          "GTIRB_PPRINTER_ALLOCATION_STATS=ON\n";
+    return;
+  }
+  std::ios_base::fmtflags flags = os.flags();
+  os << std::left << std::setw(18) << "phase" << std::right << std::setw(12)
+     << "elements" << std::setw(14) << "allocations" << std::setw(14)
+     << "bytes" << std::setw(12) << "per elem" << '\n';
+  uint64_t total = 0;
+  for (size_t i = 0; i < PhaseCount; ++i) {
+    Phase phase = static_cast<Phase>(i);
+    Counters c = get(phase);
+    total += c.allocations;
+    os << std::left << std::setw(18) << phaseName(phase) << std::right
+       << std::setw(12) << c.elements << std::setw(14) << c.allocations
+       << std::setw(14) << c.bytes << std::setw(12) << std::fixed
+       << std::setprecision(2);
+    if (phase != Phase::Other && c.elements != 0)
+      os << static_cast<double>(c.allocations) / c.elements;
+    else
+      os << '-';
+    os << '\n';
+  }
+  uint64_t instructions = get(Phase::Instruction).elements;
+  if (instructions != 0)
+    os << "allocations per instruction, all phases: " << std::fixed
+       << std::setprecision(2) << static_cast<double>(total) / instructions
+       << '\n';
+  os.flags(flags);
+}
+
+} // namespace allocation_stats
+} // namespace gtirb_pprint
+
+#ifdef GTIRB_PPRINTER_ALLOCATION_STATS
+// Count every allocation of the process in the phase of the allocating
+// thread. The default array forms call these.
+void* operator new(std::size_t size) {
+  using namespace gtirb_pprint::allocation_stats;
+  AtomicCounters& c = countersOf(currentPhase);
+  c.allocations.fetch_add(1, std::memory_order_relaxed);
+  c.bytes.fetch_add(size, std::memory_order_relaxed);
+  if (void* p = std::malloc(size ? size : 1))
+    return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+#endif // GTIRB_PPRINTER_ALLOCATION_STATS
@@ -0,0 +1,137 @@
+//===- AssemblyIndex.cpp ----------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2019 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+#include "AssemblyIndex.hpp"
+#include "Fnv.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+#include <tuple>
+
+namespace gtirb_pprint {
+
+AssemblyIndex::AssemblyIndex(const PreparedModule& prepared_)
+    : prepared(prepared_) {}
+
+void AssemblyIndex::add(const AssemblyChunk& chunk) {
+  uint64_t begin = offset;
+  offset += chunk.text.size();
+  switch (chunk.kind) {
+  case AssemblyChunk::Kind::Header:
+  case AssemblyChunk::Kind::Footer:
+    break;
+  case AssemblyChunk::Kind::SectionHeader:
+    // Only the text between two elements of the same section belongs to it.
+    if (!sections.empty() &&
+        sections.back().section == findSection(chunk.address))
+      extendSection(chunk, begin);
+    break;
+  case AssemblyChunk::Kind::FunctionHeader:
+    functionHeaderBegin = begin;
+    extendSection(chunk, begin);
+    break;
+  case AssemblyChunk::Kind::Block:
+    blocks[chunk.address] =
+        Range{chunk.address, functionHeaderBegin.value_or(begin), offset};
+    functionHeaderBegin.reset();
+    extendSection(chunk, begin);
+    break;
+  case AssemblyChunk::Kind::DataObject:
+    extendSection(chunk, begin);
+    break;
+  }
+}
+
+const gtirb::Section* AssemblyIndex::findSection(gtirb::Addr addr) const {
+  auto found = prepared.getModule().findSection(addr);
+  return found.empty() ? nullptr : &*found.begin();
+}
+
+void AssemblyIndex::extendSection(const AssemblyChunk& chunk, uint64_t begin) {
+  const gtirb::Section* section = findSection(chunk.address);
+  if (sections.empty() || sections.back().section != section)
+    sections.push_back(
+        SectionRange{section, Range{chunk.address, begin, begin},
+                     fnv::OffsetBasis});
+  SectionRange& current = sections.back();
+  current.range.end = offset;
+  current.hash = fnv::fnv1a(current.hash, chunk.text);
+}
+
+void AssemblyIndex::write(std::ostream& os) const {
+  std::ios_base::fmtflags flags = os.flags();
+  auto printRange = [&os](const Range& range) {
+    os << " 0x" << std::hex << static_cast<uint64_t>(range.address)
+       << std::dec << ' ' << range.begin << ' ' << range.end;
+  };
+
+  for (const SectionRange& section : sections) {
+    if (!section.section)
+      continue;
+    os << "section " << section.section->getName();
+    printRange(section.range);
+    os << ' ' << std::hex << std::setfill('0') << std::setw(16) << section.hash
+       << std::setfill(' ') << std::dec << '\n';
+  }
+
+  // Functions are listed in the order they appear in the output.
+  std::vector<std::tuple<uint64_t, std::string, Range>> functions;
+  for (const PreparedModule::Function& function : prepared.getFunctions()) {
+    std::optional<Range> range;
+    for (const gtirb::Block* block : function.blocks) {
+      auto found = blocks.find(block->getAddress());
+      if (found == blocks.end())
+        continue;
+      if (!range) {
+        range = found->second;
+        continue;
+      }
+      range->begin = std::min(range->begin, found->second.begin);
+      range->end = std::max(range->end, found->second.end);
+    }
+    if (!range)
+      continue;
+    std::string name;
+    for (gtirb::Addr entry : function.entries) {
+      auto symbols = prepared.getModule().findSymbols(entry);
+      if (!symbols.empty()) {
+        name = symbols.begin()->getName();
+        range->address = entry;
+        break;
+      }
+    }
+    if (name.empty())
+      continue;
+    functions.emplace_back(range->begin, name, *range);
+  }
+  std::sort(functions.begin(), functions.end(),
+            [](const auto& a, const auto& b) {
+              return std::get<0>(a) < std::get<0>(b);
+            });
+  for (const auto& [begin, name, range] : functions) {
+    os << "function " << name;
+    printRange(range);
+    os << '\n';
+  }
+
+  for (const auto& [addr, range] : blocks) {
+    os << "block";
+    printRange(range);
+    os << '\n';
+  }
+  os.flags(flags);
+}
+
+} // namespace gtirb_pprint
@@ -0,0 +1,109 @@
+//===- AsyncStreamBuf.cpp ---------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2019 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+#include "AsyncStreamBuf.hpp"
+#include "Trace.hpp"
+
+#include <algorithm>
+
+namespace gtirb_pprint {
+
+AsyncStreamBuf::AsyncStreamBuf(std::streambuf& destination_,
+                               std::size_t bufferSize,
+                               std::size_t bufferCount)
+    : destination(destination_),
+      buffers(std::max<std::size_t>(bufferCount, 2),
+              Buffer(std::max<std::size_t>(bufferSize, 1))) {
+  current = &buffers.front();
+  for (auto it = buffers.begin() + 1; it != buffers.end(); ++it)
+    freeBuffers.push_back(&*it);
+  setp(current->data(), current->data() + current->size());
+  writer = std::thread([this]() { writeBuffers(); });
+}
+
+AsyncStreamBuf::~AsyncStreamBuf() {
+  sync();
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  changed.notify_all();
+  writer.join();
+}
+
+int AsyncStreamBuf::overflow(int c) {
+  if (!submit())
+    return traits_type::eof();
+  if (!traits_type::eq_int_type(c, traits_type::eof())) {
+    *pptr() = traits_type::to_char_type(c);
+    pbump(1);
+  }
+  return traits_type::not_eof(c);
+}
+
+int AsyncStreamBuf::sync() {
+  if (!submit())
+    return -1;
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock,
+                 [this]() { return fullBuffers.empty() && !writing; });
+    if (failed)
+      return -1;
+  }
+  // The writer is idle until the next buffer is submitted.
+  return destination.pubsync() == 0 ? 0 : -1;
+}
+
+bool AsyncStreamBuf::submit() {
+  std::size_t size = pptr() - pbase();
+  std::unique_lock<std::mutex> lock(mutex);
+  if (size != 0) {
+    fullBuffers.emplace_back(current, size);
+    changed.notify_all();
+    changed.wait(lock, [this]() { return !freeBuffers.empty(); });
+    current = freeBuffers.back();
+    freeBuffers.pop_back();
+    setp(current->data(), current->data() + current->size());
+  }
+  return !failed;
+}
+
+void AsyncStreamBuf::writeBuffers() {
+  std::unique_lock<std::mutex> lock(mutex);
+  for (;;) {
+    changed.wait(lock,
+                 [this]() { return !fullBuffers.empty() || stopping; });
+    if (fullBuffers.empty())
+      return;
+    auto [buffer, size] = fullBuffers.front();
+    fullBuffers.pop_front();
+    writing = true;
+    lock.unlock();
+    std::streamsize written;
+    {
+      trace::Span span("io", "write output");
+      written = destination.sputn(buffer->data(),
+                                  static_cast<std::streamsize>(size));
+    }
+    lock.lock();
+    if (written != static_cast<std::streamsize>(size))
+      failed = true;
+    writing = false;
+    freeBuffers.push_back(buffer);
+    changed.notify_all();
+  }
+}
+
+} // namespace gtirb_pprint
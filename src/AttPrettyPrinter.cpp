@@ -14,25 +14,117 @@
 //===----------------------------------------------------------------------===//
 
 #include "AttPrettyPrinter.hpp"
+#include "AllocationStats.hpp"
+#include "NumberFormat.hpp"
 #include "string_utils.hpp"
 #include "version.h"
-#include <iomanip>
+#include <algorithm>
 
 namespace gtirb_pprint {
 
-AttPrettyPrinter::AttPrettyPrinter(gtirb::Context& context_,
-                                   gtirb::Module& module_,
+AttPrettyPrinter::AttPrettyPrinter(const PreparedModule& prepared_,
                                    const ElfSyntax& syntax_,
-                                   const PrintingPolicy& policy_)
-    : ElfPrettyPrinter(context_, module_, syntax_, policy_) {
-  cs_option(this->csHandle, CS_OPT_SYNTAX, CS_OPT_SYNTAX_ATT);
+                                   const PrintingPolicy& policy_,
+                                   std::pmr::memory_resource* resource_)
+    : ElfPrettyPrinter(prepared_, syntax_, policy_, resource_),
+      forms(resource_) {
+  csHandle = CapstoneHandle(CS_OPT_SYNTAX_ATT);
+}
+
+// Capstone lists the operands of an instruction, implicit ones included, in
+// the order of the syntax. The AT&T order is the reverse of the Intel order,
+// except for instructions whose operands are all immediates, such as enter,
+// which have the same order in both syntaxes.
+static void toAttOperandOrder(cs_x86& detail) {
+  cs_x86_op* begin = detail.operands;
+  cs_x86_op* end = begin + detail.op_count;
+  if (std::all_of(begin, end,
+                  [](const cs_x86_op& op) { return op.type == X86_OP_IMM; }))
+    return;
+  std::reverse(begin, end);
+}
+
+static bool sameOperand(const cs_x86_op& a, const cs_x86_op& b) {
+  if (a.type != b.type || a.size != b.size)
+    return false;
+  switch (a.type) {
+  case X86_OP_REG:
+    return a.reg == b.reg;
+  case X86_OP_IMM:
+    return a.imm == b.imm;
+  case X86_OP_MEM:
+    return a.mem.segment == b.mem.segment && a.mem.base == b.mem.base &&
+           a.mem.index == b.mem.index && a.mem.scale == b.mem.scale &&
+           a.mem.disp == b.mem.disp;
+  default:
+    return true;
+  }
+}
+
+// Whether the operands of the AT&T decode of an instruction are those of its
+// Intel decode in AT&T order.
+static bool sameOperands(const cs_x86& intel, const cs_x86& att) {
+  if (intel.op_count != att.op_count)
+    return false;
+  cs_x86 reordered = intel;
+  toAttOperandOrder(reordered);
+  return std::equal(reordered.operands, reordered.operands + att.op_count,
+                    att.operands, sameOperand);
+}
+
+const AttPrettyPrinter::Form& AttPrettyPrinter::getForm(const cs_insn& shared) {
+  // The AT&T form depends on the Intel mnemonic and the encoding of the
+  // instruction, not on the values of its displacement and immediate.
+  std::pmr::string key(shared.mnemonic, resource);
+  key += '\0';
+  size_t bytes = key.size();
+  key.append(reinterpret_cast<const char*>(shared.bytes), shared.size);
+  const cs_x86_encoding& encoding = shared.detail->x86.encoding;
+  auto mask = [&](uint8_t offset, uint8_t size) {
+    if (offset != 0 && offset + size <= shared.size)
+      std::fill_n(key.begin() + bytes + offset, size, '\0');
+  };
+  mask(encoding.disp_offset, encoding.disp_size);
+  mask(encoding.imm_offset, encoding.imm_size);
+
+  auto found = forms.find(key);
+  if (found == forms.end()) {
+    cs_insn* att;
+    size_t count = cs_disasm(this->csHandle, shared.bytes, shared.size,
+                             shared.address, 1, &att);
+    Form form{std::pmr::string(count == 1 ? att->mnemonic : shared.mnemonic,
+                               resource),
+              count == 1 && sameOperands(shared.detail->x86, att->detail->x86)};
+    cs_free(att, count);
+    found = forms.emplace(std::move(key), std::move(form)).first;
+  }
+  return found->second;
+}
+
+DecodedInstructions
+AttPrettyPrinter::adaptInstructions(const gtirb::Block& x,
+                                    const DecodedInstructions& shared) {
+  DecodedInstructions insns = DecodedInstructions::copy(shared);
+  for (size_t i = 0; i < insns.size(); ++i) {
+    const Form& form = getForm(shared[i]);
+    if (!form.adaptable)
+      return decodeBlock(x);
+    cs_insn& inst = insns.modify(i);
+    size_t length = std::min(form.mnemonic.size(), sizeof(inst.mnemonic) - 1);
+    std::copy_n(form.mnemonic.begin(), length, inst.mnemonic);
+    inst.mnemonic[length] = '\0';
+    toAttOperandOrder(inst.detail->x86);
+  }
+  return insns;
 }
 
 void AttPrettyPrinter::printHeader(std::ostream& /*os*/) {}
 
 std::string AttPrettyPrinter::getRegisterName(unsigned int reg) const {
-  return std::string{"%"} +
-         ascii_str_tolower(PrettyPrinterBase::getRegisterName(reg));
+  std::string name{"%"};
+  if (reg != X86_REG_INVALID)
+    name += cs_reg_name(this->csHandle, reg);
+  return ascii_str_tolower(std::move(name));
 }
 
 void AttPrettyPrinter::printOpRegdirect(std::ostream& os, const cs_insn& inst,
@@ -42,7 +134,7 @@ void AttPrettyPrinter::printOpRegdirect(std::ostream& os, const cs_insn& inst,
   if (cs_insn_group(this->csHandle, &inst, CS_GRP_CALL) ||
       cs_insn_group(this->csHandle, &inst, CS_GRP_JUMP))
     os << '*';
-  os << getRegisterName(op.reg);
+  os << registerName(op.reg);
 }
 
 void AttPrettyPrinter::printOpImmediate(
@@ -60,12 +152,13 @@ void AttPrettyPrinter::printOpImmediate(
 
   if (const gtirb::SymAddrConst* s = this->getSymbolicImmediate(symbolic)) {
     this->printSymbolicExpression(os, s, !is_call && !is_jump);
+  } else if (is_call || is_jump) {
+    // Like std::showbase, no prefix for zero.
+    if (op.imm != 0)
+      os << "0x";
+    number_format::writeHex(os, static_cast<uint64_t>(op.imm));
   } else {
-    std::ios_base::fmtflags flags = os.flags();
-    if (is_call || is_jump)
-      os << std::setbase(16) << std::showbase;
-    os << op.imm;
-    os.flags(flags);
+    number_format::writeDecimal(os, op.imm);
   }
 }
 
@@ -85,7 +178,7 @@ void AttPrettyPrinter::printOpIndirect(
       cs_insn_group(this->csHandle, &inst, CS_GRP_JUMP))
     os << '*';
   if (has_segment)
-    os << getRegisterName(op.mem.segment) << ':';
+    os << registerName(op.mem.segment) << ':';
 
   if (const auto* s = std::get_if<gtirb::SymAddrConst>(symbolic)) {
     // Displacement is symbolic.
@@ -93,11 +186,10 @@ void AttPrettyPrinter::printOpIndirect(
   } else {
     // Displacement is numeric.
     if (!has_segment && !has_base && !has_index) {
-      std::ios_base::fmtflags flags = os.flags();
-      os << "0x" << std::hex << op.mem.disp;
-      os.flags(flags);
+      os << "0x";
+      number_format::writeHex(os, static_cast<uint64_t>(op.mem.disp));
     } else if (op.mem.disp != 0 || has_segment) {
-      os << op.mem.disp;
+      number_format::writeDecimal(os, op.mem.disp);
     } else {
       // Print nothing. There is no segment register and the base or index
       // register will be printed, so the zero displacement is implicit.
@@ -108,9 +200,9 @@ void AttPrettyPrinter::printOpIndirect(
   if (has_base || has_index) {
     os << '(';
     if (has_base)
-      os << getRegisterName(op.mem.base);
+      os << registerName(op.mem.base);
     if (has_index) {
-      os << ',' << getRegisterName(op.mem.index);
+      os << ',' << registerName(op.mem.index);
       if (op.mem.scale != 1)
         os << ',' << op.mem.scale;
     }
@@ -118,17 +210,20 @@ void AttPrettyPrinter::printOpIndirect(
   }
 }
 
+template class StaticPrettyPrinter<AttPrettyPrinter>;
+
 const PrintingPolicy& AttPrettyPrinterFactory::defaultPrintingPolicy() const {
   return ElfPrettyPrinter::defaultPrintingPolicy();
 }
 
 std::unique_ptr<PrettyPrinterBase>
-AttPrettyPrinterFactory::create(gtirb::Context& gtirb_context,
-                                gtirb::Module& module,
-                                const PrintingPolicy& policy) {
+AttPrettyPrinterFactory::create(const PreparedModule& prepared,
+                                const PrintingPolicy& policy,
+                                std::pmr::memory_resource* resource) {
   static const ElfSyntax syntax{};
-  return std::make_unique<AttPrettyPrinter>(gtirb_context, module, syntax,
-                                            policy);
+  allocation_stats::Scope scope(allocation_stats::Phase::Setup);
+  return std::make_unique<StaticPrettyPrinter<AttPrettyPrinter>>(
+      prepared, syntax, policy, resource);
 }
 
 volatile bool AttPrettyPrinter::registered = registerPrinter(
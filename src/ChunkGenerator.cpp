@@ -0,0 +1,196 @@
+//===- ChunkGenerator.cpp ---------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2019 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+#include "ChunkGenerator.hpp"
+#include "AllocationStats.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+namespace gtirb_pprint {
+
+ChunkGenerator::ChunkGenerator(
+    std::unique_ptr<std::pmr::memory_resource> resource_,
+    std::unique_ptr<PrettyPrinterBase> printer_)
+    : resource(std::move(resource_)), printer(std::move(printer_)) {}
+
+ChunkGenerator::ChunkGenerator(gtirb::Context& context, gtirb::Module& module,
+                               std::shared_ptr<PrettyPrinterFactory> factory,
+                               PrintingPolicy policy)
+    : sections(Sections{&context, &module, std::move(factory),
+                        std::move(policy), getSectionStarts(module), 0,
+                        nullptr, nullptr}) {
+  prepareSection(0);
+}
+
+void ChunkGenerator::prepareSection(size_t section) {
+  // Release the printer of the previous section before what it uses.
+  printer.reset();
+  preparedSection.reset();
+  resource = std::make_unique<std::pmr::monotonic_buffer_resource>();
+
+  // A seek only prepares its own section. Going through the sections in
+  // order is cheaper from an index of the whole module.
+  if (!sections->index && section == sections->current + 1)
+    sections->index = std::make_unique<AddressIndex>(*sections->context,
+                                                     *sections->module);
+  gtirb::Addr start = sections->starts[section];
+  gtirb::Addr end = section + 1 < sections->starts.size()
+                        ? sections->starts[section + 1]
+                        : gtirb::Addr{std::numeric_limits<uint64_t>::max()};
+  if (sections->index)
+    preparedSection = std::make_unique<PreparedModule>(
+        *sections->index, start, end, resource.get());
+  else
+    preparedSection = std::make_unique<PreparedModule>(
+        *sections->context, *sections->module, start, end, resource.get());
+  printer = sections->factory->create(*preparedSection, sections->policy,
+                                      resource.get());
+  if (sections->skippedRanges)
+    printer->setSkippedRanges(sections->skippedRanges);
+  else
+    sections->skippedRanges = printer->getSkippedRanges();
+  sections->current = section;
+  blockIndex = 0;
+  dataIndex = 0;
+}
+
+std::optional<AssemblyChunk> ChunkGenerator::next() {
+  while (pending.empty()) {
+    switch (stage) {
+    case Stage::Header: {
+      std::ostringstream os;
+      allocation_stats::Scope scope(allocation_stats::Phase::FileHeader);
+      printer->printHeader(os);
+      push(AssemblyChunk::Kind::Header, gtirb::Addr{0}, os.str());
+      stage = Stage::Elements;
+      break;
+    }
+    case Stage::Elements:
+      produceNextElement();
+      break;
+    case Stage::Footer: {
+      std::ostringstream os;
+      printer->printModuleEnd(os, last);
+      push(AssemblyChunk::Kind::Footer, last, os.str());
+      stage = Stage::Done;
+      break;
+    }
+    case Stage::Done:
+      return std::nullopt;
+    }
+  }
+  AssemblyChunk chunk = std::move(pending.front());
+  pending.pop_front();
+  return chunk;
+}
+
+void ChunkGenerator::seek(gtirb::Addr addr) {
+  if (sections) {
+    const std::vector<gtirb::Addr>& starts = sections->starts;
+    size_t section =
+        std::upper_bound(starts.begin(), starts.end(), addr) - starts.begin();
+    if (section - 1 != sections->current)
+      prepareSection(section - 1);
+  }
+  const PreparedModule& prepared = printer->prepared;
+  auto byAddress = [](const auto* x, gtirb::Addr a) {
+    return x->getAddress() < a;
+  };
+  const auto& blocks = prepared.getBlocks();
+  const auto& dataObjects = prepared.getDataObjects();
+  blockIndex = std::lower_bound(blocks.begin(), blocks.end(), addr, byAddress) -
+               blocks.begin();
+  dataIndex = std::lower_bound(dataObjects.begin(), dataObjects.end(), addr,
+                               byAddress) -
+              dataObjects.begin();
+  last = gtirb::Addr{0};
+  resumed = true;
+  pending.clear();
+  if (stage != Stage::Header)
+    stage = Stage::Elements;
+}
+
+void ChunkGenerator::produceNextElement() {
+  const PreparedModule& prepared = printer->prepared;
+  const auto& blocks = prepared.getBlocks();
+  const auto& dataObjects = prepared.getDataObjects();
+  bool hasBlock = blockIndex < blocks.size();
+  bool hasData = dataIndex < dataObjects.size();
+  if (!hasBlock && !hasData) {
+    if (sections && sections->current + 1 < sections->starts.size())
+      prepareSection(sections->current + 1);
+    else
+      stage = Stage::Footer;
+    return;
+  }
+  // Same order as PrettyPrinterBase::printAll.
+  bool isBlock =
+      hasBlock && (!hasData || blocks[blockIndex]->getAddress() <=
+                                   dataObjects[dataIndex]->getAddress());
+  gtirb::Addr addr = isBlock ? blocks[blockIndex]->getAddress()
+                             : dataObjects[dataIndex]->getAddress();
+  if (resumed) {
+    printer->rangeStart = addr;
+    resumed = false;
+  }
+
+  std::ostringstream prologue;
+  bool printed = printer->printElementPrologue(prologue, addr, last);
+  push(AssemblyChunk::Kind::SectionHeader, addr, prologue.str());
+  if (isBlock) {
+    const gtirb::Block& block = *blocks[blockIndex++];
+    if (printed) {
+      allocation_stats::Scope scope(allocation_stats::Phase::Block);
+      last = addr + block.getSize();
+      if (!printer->skipEA(addr)) {
+        std::ostringstream header;
+        printer->printFunctionHeader(header, addr);
+        push(AssemblyChunk::Kind::FunctionHeader, addr, header.str());
+        std::ostringstream contents;
+        printer->printBlockContents(contents, block);
+        push(AssemblyChunk::Kind::Block, addr, contents.str());
+      }
+    }
+  } else {
+    const gtirb::DataObject& dataObject = *dataObjects[dataIndex++];
+    if (printed) {
+      std::ostringstream contents;
+      printer->printDataObject(contents, dataObject);
+      push(AssemblyChunk::Kind::DataObject, addr, contents.str());
+      last = addr + dataObject.getSize();
+    }
+  }
+
+  // Same as PrettyPrinterBase::printAll: jump over the rest of a skipped
+  // region.
+  if (std::optional<gtirb::Addr> end = printer->getSkippedRegionEnd(addr)) {
+    auto blockIt = blocks.begin() + blockIndex;
+    auto dataIt = dataObjects.begin() + dataIndex;
+    last = PrettyPrinterBase::skipElements(blockIt, blocks.end(), *end, last);
+    last = PrettyPrinterBase::skipElements(dataIt, dataObjects.end(), *end,
+                                           last);
+    blockIndex = blockIt - blocks.begin();
+    dataIndex = dataIt - dataObjects.begin();
+  }
+}
+
+void ChunkGenerator::push(AssemblyChunk::Kind kind, gtirb::Addr address,
+                          std::string text) {
+  if (!text.empty())
+    pending.push_back(AssemblyChunk{kind, address, std::move(text)});
+}
+
+} // namespace gtirb_pprint
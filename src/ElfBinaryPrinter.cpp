@@ -14,6 +14,9 @@
 //===----------------------------------------------------------------------===//
 #include "ElfBinaryPrinter.hpp"
 
+#include "Trace.hpp"
+#include "file_utils.hpp"
+
 #ifdef __GNUC__
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wpragmas"
@@ -26,16 +29,23 @@
 #pragma warning(push)
 #pragma warning(disable : 4456) // variable shadowing warning
 #endif // __GNUC__
+#include <boost/filesystem/operations.hpp>
 #include <boost/process/search_path.hpp>
 #include <boost/process/system.hpp>
+#include <boost/uuid/detail/sha1.hpp>
 #ifdef __GNUC__
 #pragma GCC diagnostic pop
 #elif defined(_MSC_VER)
 #pragma warning(pop)
 #endif // __GNUC__
+#include <cstdint>
+#include <iomanip>
 #include <iostream>
+#include <random>
 #include <regex>
+#include <sstream>
 #include <string>
+#include <system_error>
 #include <vector>
 #ifdef USE_STD_FILESYSTEM_LIB
 #include <filesystem>
@@ -47,6 +57,43 @@ namespace fs = std::experimental::filesystem;
 
 namespace bp = boost::process;
 
+namespace {
+
+// A SHA-1 digest of a list of strings. Each string is preceded by its length,
+// so that different lists never hash alike.
+class CacheKey {
+public:
+  CacheKey& add(const std::string& s) {
+    uint64_t size = s.size();
+    hash.process_bytes(&size, sizeof(size));
+    hash.process_bytes(s.data(), s.size());
+    return *this;
+  }
+
+  std::string str() {
+    boost::uuids::detail::sha1::digest_type digest;
+    hash.get_digest(digest);
+    std::ostringstream os;
+    os << std::hex << std::setfill('0');
+    // The digest is made of 32-bit words or of bytes depending on Boost.
+    for (const auto& part : digest)
+      os << std::setw(sizeof(part) * 2) << static_cast<uint64_t>(part);
+    return os.str();
+  }
+
+private:
+  boost::uuids::detail::sha1 hash;
+};
+
+// A name next to the given cache entry for writing it before it is renamed
+// into place, so that concurrent links never see a partial entry.
+fs::path temporaryEntry(const fs::path& entry) {
+  static thread_local std::mt19937_64 random{std::random_device{}()};
+  return fs::path(entry).concat(".tmp" + std::to_string(random()));
+}
+
+} // namespace
+
 namespace gtirb_bprint {
 
 std::optional<std::string>
@@ -147,35 +194,6 @@ std::vector<std::string> ElfBinaryPrinter::buildCompilerArgs(
   return args;
 }
 
-/// Auxiliary class to make sure we delete the temporary assembly file at the
-/// end
-class TempFile {
-public:
-  std::string name;
-  std::ofstream fileStream;
-  TempFile() {
-#ifdef _WIN32
-    std::string tmpFileName;
-    std::FILE* f = nullptr;
-    while (!f) {
-      tmpFileName = std::tmpnam(nullptr);
-      tmpFileName += ".s";
-      f = fopen(tmpFileName.c_str(), "wx");
-    }
-    fclose(f);
-#else
-    char tmpFileName[] = "/tmp/fileXXXXXX.s";
-    close(mkstemps(tmpFileName, 2)); // Create tmp file
-#endif // _WIN32
-    name = tmpFileName;
-    fileStream.open(name);
-  };
-  ~TempFile() {
-    if (fs::exists(name))
-      fs::remove(name);
-  };
-};
-
 int ElfBinaryPrinter::link(std::string outputFilename,
                            const std::vector<std::string>& extraCompilerArgs,
                            const std::vector<std::string>& userLibraryPaths,
@@ -183,6 +201,9 @@ int ElfBinaryPrinter::link(std::string outputFilename,
                            gtirb::Context& ctx, gtirb::IR& ir) const {
   if (debug)
     std::cout << "Generating binary file" << std::endl;
+  if (!cacheDirectory.empty())
+    return linkCached(outputFilename, extraCompilerArgs, userLibraryPaths, pp,
+                      ctx, ir);
   std::vector<TempFile> tempFiles(
       std::distance(ir.modules().begin(), ir.modules().end()));
   std::vector<std::string> tempFileNames;
@@ -192,6 +213,8 @@ int ElfBinaryPrinter::link(std::string outputFilename,
       if (debug)
         std::cout << "Printing module" << module.getName()
                   << " to temporary file " << tempFiles[i].name << std::endl;
+      gtirb_pprint::trace::Span span("io", "write temporary file",
+                                     tempFiles[i].name);
       pp.print(tempFiles[i].fileStream, ctx, module);
       tempFiles[i].fileStream.close();
       tempFileNames.push_back(tempFiles[i].name);
@@ -202,16 +225,149 @@ int ElfBinaryPrinter::link(std::string outputFilename,
     ++i;
   }
 
+  return callCompiler(outputFilename, tempFileNames, extraCompilerArgs,
+                      userLibraryPaths, ir);
+}
+
+int ElfBinaryPrinter::linkCached(
+    const std::string& outputFilename,
+    const std::vector<std::string>& extraCompilerArgs,
+    const std::vector<std::string>& userLibraryPaths,
+    const gtirb_pprint::PrettyPrinter& pp, gtirb::Context& ctx,
+    gtirb::IR& ir) const {
+  fs::path objectDirectory = fs::path(cacheDirectory) / "objects";
+  fs::path binaryDirectory = fs::path(cacheDirectory) / "binaries";
+  std::error_code ec;
+  fs::create_directories(objectDirectory, ec);
+  if (!ec)
+    fs::create_directories(binaryDirectory, ec);
+  if (ec) {
+    std::cerr << "ERROR: Could not create the cache directory "
+              << cacheDirectory << ": " << ec.message() << "\n";
+    return -1;
+  }
+
+  // A different compiler may produce different objects.
   boost::filesystem::path compilerPath = bp::search_path(this->compiler);
   if (compilerPath.empty()) {
     std::cerr << "ERROR: Could not find compiler" << this->compiler;
     return -1;
   }
+  CacheKey compilerKey;
+  compilerKey.add(compilerPath.string())
+      .add(std::to_string(boost::filesystem::file_size(compilerPath)))
+      .add(std::to_string(boost::filesystem::last_write_time(compilerPath)));
+  std::string compilerId = compilerKey.str();
+
+  std::vector<std::string> objects;
+  for (gtirb::Module& module : ir.modules()) {
+    std::ostringstream assembly;
+    pp.print(assembly, ctx, module);
+    CacheKey key;
+    key.add(compilerId);
+    for (const std::string& arg : extraCompilerArgs)
+      key.add(arg);
+    key.add(assembly.str());
+    fs::path object = objectDirectory / (key.str() + ".o");
+    objects.push_back(object.string());
+    if (fs::exists(object)) {
+      if (debug)
+        std::cout << "Reusing cached object " << object << " for module "
+                  << module.getName() << std::endl;
+      continue;
+    }
+
+    TempFile asmFile;
+    if (!asmFile.fileStream) {
+      std::cerr << "ERROR: Could not write assembly into a temporary file.\n";
+      return -1;
+    }
+    {
+      gtirb_pprint::trace::Span span("io", "write temporary file",
+                                     asmFile.name);
+      asmFile.fileStream << assembly.str();
+      asmFile.fileStream.close();
+    }
+    fs::path temporary = temporaryEntry(object);
+    std::vector<std::string> args{"-c", "-o", temporary.string(),
+                                  asmFile.name};
+    args.insert(args.end(), extraCompilerArgs.begin(),
+                extraCompilerArgs.end());
+    if (debug)
+      std::cout << "Assembling module " << module.getName() << std::endl;
+    if (int status = runCompiler(args); status != 0) {
+      fs::remove(temporary, ec);
+      return status;
+    }
+    fs::rename(temporary, object, ec);
+    if (ec) {
+      std::cerr << "ERROR: Could not add " << object
+                << " to the cache: " << ec.message() << "\n";
+      return -1;
+    }
+  }
+
+  // The output file name is not part of the key: the binary is linked in the
+  // cache and copied to the output file.
+  std::vector<std::string> args = buildCompilerArgs(
+      "", objects, extraCompilerArgs, userLibraryPaths, ir);
+  CacheKey key;
+  key.add(compilerId);
+  for (const std::string& arg : args)
+    key.add(arg);
+  fs::path binary = binaryDirectory / key.str();
+  if (fs::exists(binary)) {
+    if (debug)
+      std::cout << "Reusing cached binary " << binary << std::endl;
+  } else {
+    fs::path temporary = temporaryEntry(binary);
+    // buildCompilerArgs starts with "-o OUTPUT".
+    args[1] = temporary.string();
+    if (debug)
+      std::cout << "Calling compiler" << std::endl;
+    if (int status = runCompiler(args); status != 0) {
+      fs::remove(temporary, ec);
+      return status;
+    }
+    fs::rename(temporary, binary, ec);
+    if (ec) {
+      std::cerr << "ERROR: Could not add " << binary
+                << " to the cache: " << ec.message() << "\n";
+      return -1;
+    }
+  }
+  fs::copy_file(binary, outputFilename, fs::copy_options::overwrite_existing,
+                ec);
+  if (ec) {
+    std::cerr << "ERROR: Could not write " << outputFilename << ": "
+              << ec.message() << "\n";
+    return -1;
+  }
+  return 0;
+}
+
+int ElfBinaryPrinter::callCompiler(
+    const std::string& outputFilename, const std::vector<std::string>& inputs,
+    const std::vector<std::string>& extraCompilerArgs,
+    const std::vector<std::string>& userLibraryPaths, gtirb::IR& ir) const {
   if (debug)
     std::cout << "Calling compiler" << std::endl;
-  return bp::system(compilerPath,
-                    buildCompilerArgs(outputFilename, tempFileNames,
-                                      extraCompilerArgs, userLibraryPaths, ir));
+  return runCompiler(buildCompilerArgs(outputFilename, inputs,
+                                       extraCompilerArgs, userLibraryPaths,
+                                       ir));
+}
+
+int ElfBinaryPrinter::runCompiler(const std::vector<std::string>& args) const {
+  boost::filesystem::path compilerPath = bp::search_path(this->compiler);
+  if (compilerPath.empty()) {
+    std::cerr << "ERROR: Could not find compiler" << this->compiler;
+    return -1;
+  }
+  std::string commandLine = compilerPath.string();
+  for (const std::string& arg : args)
+    commandLine += ' ' + arg;
+  gtirb_pprint::trace::Span span("process", this->compiler, commandLine);
+  return bp::system(compilerPath, args);
 }
 
 } // namespace gtirb_bprint
@@ -0,0 +1,828 @@
+//===- ElfObjectBinaryPrinter.cpp -------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2019 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+#include "ElfObjectBinaryPrinter.hpp"
+#include "NumberFormat.hpp"
+
+#include "Trace.hpp"
+#include "file_utils.hpp"
+#include <algorithm>
+#include <capstone/capstone.h>
+#include <cassert>
+#include <cstring>
+#include <elf.h>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <sstream>
+#include <tuple>
+#include <utility>
+#include <variant>
+#include <vector>
+
+template <class T> T* nodeFromUUID(gtirb::Context& C, gtirb::UUID id) {
+  return dyn_cast_or_null<T>(gtirb::Node::getByUUID(C, id));
+}
+
+namespace gtirb_bprint {
+
+namespace {
+
+/// String table section contents. Identical strings are stored once.
+class StringTable {
+public:
+  uint32_t add(const std::string& str) {
+    if (str.empty())
+      return 0;
+    auto [it, inserted] =
+        offsets.emplace(str, static_cast<uint32_t>(contents.size()));
+    if (inserted) {
+      contents += str;
+      contents += '\0';
+    }
+    return it->second;
+  }
+
+  const std::string& data() const { return contents; }
+
+private:
+  std::string contents{'\0'};
+  std::map<std::string, uint32_t> offsets;
+};
+
+/// Reference to an entry of the symbol table being built. Local symbols must
+/// precede global ones in the table, so the final index of a global symbol is
+/// only known once all local symbols have been collected. The local symbol 0
+/// is the null symbol, used for relocations against absolute addresses.
+struct SymbolRef {
+  bool global = false;
+  uint32_t index = 0;
+
+  bool operator==(const SymbolRef& other) const {
+    return global == other.global && index == other.index;
+  }
+};
+
+struct Relocation {
+  uint64_t offset;
+  uint32_t type;
+  SymbolRef symbol;
+  int64_t addend;
+};
+
+/// A section of the object being written.
+struct OutputSection {
+  const gtirb::Section* section;
+  uint32_t type;
+  uint64_t flags;
+  uint64_t align;
+  uint64_t size;
+  std::vector<char> contents;
+
+  /// Array sections only keep the entries that are not excluded by the
+  /// printing policy. In that case this maps the address of each kept data
+  /// object to its offset and size in the output section.
+  bool filtered = false;
+  std::map<gtirb::Addr, std::pair<uint64_t, uint64_t>> keptObjects;
+
+  std::vector<Relocation> relocations;
+  uint16_t index = 0;
+  SymbolRef symbol;
+};
+
+/// Where a symbolic reference points to in the object being written.
+struct Target {
+  SymbolRef symbol;
+  int64_t addend = 0;
+  bool plt = false;
+  bool got = false;
+  bool tls = false;
+};
+
+class ElfObjectWriter {
+public:
+  ElfObjectWriter(const gtirb_pprint::PrettyPrinter& pp,
+                  gtirb::Context& context, gtirb::Module& module);
+
+  bool write(std::ostream& out);
+
+private:
+  gtirb::Module& module;
+  const gtirb_pprint::PreparedModule prepared;
+  /// The printer of the module, which names the functions and finds the
+  /// skipped ones as when printing the module.
+  const std::unique_ptr<gtirb_pprint::PrettyPrinterBase> printer;
+  gtirb_pprint::PrintingPolicy policy;
+  std::shared_ptr<const std::vector<gtirb_pprint::AddrRange>> skippedRanges;
+  gtirb_pprint::CapstoneHandle csHandle;
+  bool ok = true;
+
+  std::vector<OutputSection> sections;
+
+  std::vector<Elf64_Sym> localSymbols;
+  std::vector<Elf64_Sym> globalSymbols;
+  std::map<std::string, uint32_t> globalSymbolIndex;
+  StringTable symbolNames;
+
+  void collectSections();
+  void collectSymbols();
+  void collectCodeRelocations();
+  void collectDataRelocations();
+  void writeFile(std::ostream& out);
+
+  bool isSkipped(gtirb::Addr x) const;
+  bool isSectionSkipped(const std::string& name) const;
+  std::pair<uint32_t, uint64_t>
+  getSectionProperties(const gtirb::Section& section) const;
+
+  OutputSection* getOutputSection(gtirb::Addr addr);
+  std::optional<uint64_t> getOutputOffset(const OutputSection& section,
+                                          gtirb::Addr addr) const;
+
+  SymbolRef getGlobalSymbol(const std::string& name);
+  Target resolve(const gtirb::Symbol& symbol, bool inData);
+
+  void addInstructionRelocations(OutputSection& section, const cs_insn& inst);
+  void addRelocation(OutputSection& section, gtirb::Addr place, uint64_t size,
+                     bool pcRelative, bool signExtended, int64_t bias,
+                     const gtirb::Symbol& symbol, int64_t offset, bool inData);
+
+  uint32_t getSymbolIndex(const SymbolRef& ref) const {
+    return ref.global ? static_cast<uint32_t>(localSymbols.size()) + ref.index
+                      : ref.index;
+  }
+
+  void error(gtirb::Addr ea, const std::string& message) {
+    std::cerr << "ERROR: at address 0x" << std::hex
+              << static_cast<uint64_t>(ea) << std::dec << ": " << message
+              << std::endl;
+    ok = false;
+  }
+};
+
+ElfObjectWriter::ElfObjectWriter(const gtirb_pprint::PrettyPrinter& pp,
+                                 gtirb::Context& context,
+                                 gtirb::Module& module_)
+    : module(module_), prepared(context, module_),
+      printer(pp.makePrinter(prepared)), policy(pp.getPolicy(module_)),
+      skippedRanges(printer->getSkippedRanges()) {
+  // Unwind information is not regenerated, and a verbatim copy of .eh_frame
+  // would refer to the original code locations.
+  policy.skipSections.insert(".eh_frame");
+  policy.skipSections.insert(".eh_frame_hdr");
+}
+
+bool ElfObjectWriter::write(std::ostream& out) {
+  collectSections();
+  collectSymbols();
+  collectCodeRelocations();
+  collectDataRelocations();
+  if (!ok)
+    return false;
+  writeFile(out);
+  return static_cast<bool>(out);
+}
+
+bool ElfObjectWriter::isSectionSkipped(const std::string& name) const {
+  return policy.skipSections.count(name) > 0;
+}
+
+bool ElfObjectWriter::isSkipped(gtirb::Addr x) const {
+  auto found = module.findSection(x);
+  if (found.begin() != found.end() &&
+      isSectionSkipped(found.begin()->getName()))
+    return true;
+  auto it = std::upper_bound(
+      skippedRanges->begin(), skippedRanges->end(), x,
+      [](gtirb::Addr a, const gtirb_pprint::AddrRange& range) {
+        return a < range.first;
+      });
+  return it != skippedRanges->begin() && x < std::prev(it)->second;
+}
+
+// Whether a section name is \p prefix or starts with \p prefix followed by a
+// dot, the way the assembler recognizes special sections.
+static bool hasSectionPrefix(const std::string& name,
+                             const std::string& prefix) {
+  return name.compare(0, prefix.size(), prefix) == 0 &&
+         (name.size() == prefix.size() || name[prefix.size()] == '.');
+}
+
+// The type and flags the assembler gives to a section declared without
+// them, as the pretty printer does for modules without elfSectionProperties.
+static std::pair<uint32_t, uint64_t>
+getDefaultSectionProperties(const std::string& name) {
+  static const std::vector<std::tuple<std::string, uint32_t, uint64_t>>
+      Special{
+          {".text", SHT_PROGBITS, SHF_ALLOC | SHF_EXECINSTR},
+          {".init", SHT_PROGBITS, SHF_ALLOC | SHF_EXECINSTR},
+          {".fini", SHT_PROGBITS, SHF_ALLOC | SHF_EXECINSTR},
+          {".rodata", SHT_PROGBITS, SHF_ALLOC},
+          {".eh_frame", SHT_PROGBITS, SHF_ALLOC},
+          {".gcc_except_table", SHT_PROGBITS, SHF_ALLOC},
+          {".note", SHT_NOTE, SHF_ALLOC},
+          {".data", SHT_PROGBITS, SHF_ALLOC | SHF_WRITE},
+          {".bss", SHT_NOBITS, SHF_ALLOC | SHF_WRITE},
+          {".tdata", SHT_PROGBITS, SHF_ALLOC | SHF_WRITE | SHF_TLS},
+          {".tbss", SHT_NOBITS, SHF_ALLOC | SHF_WRITE | SHF_TLS},
+          {".init_array", SHT_INIT_ARRAY, SHF_ALLOC | SHF_WRITE},
+          {".fini_array", SHT_FINI_ARRAY, SHF_ALLOC | SHF_WRITE},
+          {".preinit_array", SHT_PREINIT_ARRAY, SHF_ALLOC | SHF_WRITE},
+          {".got", SHT_PROGBITS, SHF_ALLOC | SHF_WRITE},
+      };
+  for (const auto& [prefix, type, flags] : Special)
+    if (hasSectionPrefix(name, prefix))
+      return {type, flags};
+  return {SHT_PROGBITS, 0};
+}
+
+std::pair<uint32_t, uint64_t>
+ElfObjectWriter::getSectionProperties(const gtirb::Section& section) const {
+  if (const auto* elfSectionProperties = module.getAuxData<
+          std::map<gtirb::UUID, std::tuple<uint64_t, uint64_t>>>(
+          "elfSectionProperties")) {
+    auto found = elfSectionProperties->find(section.getUUID());
+    if (found != elfSectionProperties->end())
+      return {static_cast<uint32_t>(std::get<0>(found->second)),
+              std::get<1>(found->second)};
+  }
+  return getDefaultSectionProperties(section.getName());
+}
+
+void ElfObjectWriter::collectSections() {
+  // Only sections with blocks or data objects are printed by the pretty
+  // printer; the others are created by the linker.
+  std::set<const gtirb::Section*> used;
+  auto markUsed = [&](gtirb::Addr addr) {
+    auto found = module.findSection(addr);
+    if (found.begin() != found.end())
+      used.insert(&*found.begin());
+  };
+  for (const gtirb::Block* block : prepared.getBlocks())
+    markUsed(block->getAddress());
+  for (const gtirb::DataObject* dataObject : prepared.getDataObjects())
+    markUsed(dataObject->getAddress());
+
+  std::vector<const gtirb::Section*> ordered;
+  for (const gtirb::Section& section : module.sections())
+    if (used.count(&section) && !isSectionSkipped(section.getName()))
+      ordered.push_back(&section);
+  std::sort(ordered.begin(), ordered.end(),
+            [](const gtirb::Section* a, const gtirb::Section* b) {
+              return a->getAddress() < b->getAddress();
+            });
+
+  for (const gtirb::Section* section : ordered) {
+    OutputSection out;
+    out.section = section;
+    const std::string& name = section->getName();
+    std::tie(out.type, out.flags) = getSectionProperties(*section);
+    if (name == ".init_array")
+      out.type = SHT_INIT_ARRAY;
+    else if (name == ".fini_array")
+      out.type = SHT_FINI_ARRAY;
+
+    // Same alignment as the one printed in the section header.
+    uint64_t address{section->getAddress()};
+    if (policy.arraySections.count(name))
+      out.align = 8;
+    else
+      for (out.align = 16; out.align > 1 && address % out.align != 0;)
+        out.align /= 2;
+
+    if (out.type == SHT_NOBITS) {
+      out.size = section->getSize();
+    } else if (policy.arraySections.count(name)) {
+      // Drop the entries that refer to skipped code, as
+      // ElfPrettyPrinter::shouldExcludeDataElement does.
+      out.filtered = true;
+      gtirb::Addr end = section->getAddress() + section->getSize();
+      for (const gtirb::DataObject* dataObject : prepared.getDataObjects()) {
+        gtirb::Addr addr = dataObject->getAddress();
+        if (addr < section->getAddress() || addr >= end)
+          continue;
+        auto found = module.findSymbolicExpression(addr);
+        if (found != module.symbolic_expr_end()) {
+          const auto* s = std::get_if<gtirb::SymAddrConst>(&*found);
+          if (s && s->Sym->getAddress() && isSkipped(*s->Sym->getAddress()))
+            continue;
+        }
+        auto bytes = getBytes(module.getImageByteMap(), *dataObject);
+        out.keptObjects[addr] = {out.contents.size(), dataObject->getSize()};
+        for (std::byte b : bytes)
+          out.contents.push_back(static_cast<char>(b));
+      }
+      out.size = out.contents.size();
+    } else {
+      // The bytes of skipped functions are kept, so that the other code keeps
+      // its offsets, but nothing refers to them and their own references are
+      // not relocated.
+      for (std::byte b : getBytes(module.getImageByteMap(), *section))
+        out.contents.push_back(static_cast<char>(b));
+      out.size = out.contents.size();
+    }
+    out.index = static_cast<uint16_t>(sections.size() + 1);
+    sections.push_back(std::move(out));
+  }
+}
+
+OutputSection* ElfObjectWriter::getOutputSection(gtirb::Addr addr) {
+  auto it = std::upper_bound(
+      sections.begin(), sections.end(), addr,
+      [](gtirb::Addr a, const OutputSection& s) {
+        return a < s.section->getAddress();
+      });
+  if (it == sections.begin())
+    return nullptr;
+  --it;
+  // Symbols may point to the end of their section.
+  if (addr > it->section->getAddress() + it->section->getSize())
+    return nullptr;
+  return &*it;
+}
+
+std::optional<uint64_t>
+ElfObjectWriter::getOutputOffset(const OutputSection& section,
+                                 gtirb::Addr addr) const {
+  if (!section.filtered)
+    return static_cast<uint64_t>(addr - section.section->getAddress());
+  auto it = section.keptObjects.upper_bound(addr);
+  if (it == section.keptObjects.begin())
+    return std::nullopt;
+  --it;
+  uint64_t delta = static_cast<uint64_t>(addr - it->first);
+  if (delta >= it->second.second)
+    return std::nullopt;
+  return it->second.first + delta;
+}
+
+void ElfObjectWriter::collectSymbols() {
+  localSymbols.push_back(Elf64_Sym{});
+  for (OutputSection& section : sections) {
+    Elf64_Sym sym{};
+    sym.st_info = ELF64_ST_INFO(STB_LOCAL, STT_SECTION);
+    sym.st_shndx = section.index;
+    section.symbol = {false, static_cast<uint32_t>(localSymbols.size())};
+    localSymbols.push_back(sym);
+  }
+
+  // Function entries are made global with the names the pretty printer uses
+  // in their .globl directives.
+  std::set<std::pair<gtirb::Addr, std::string>> definedGlobals;
+  for (gtirb::Addr entry : prepared.getModuleFunctionEntries()) {
+    if (isSkipped(entry))
+      continue;
+    OutputSection* section = getOutputSection(entry);
+    if (!section)
+      continue;
+    std::string name = printer->getFunctionName(entry);
+    if (globalSymbolIndex.count(name))
+      continue;
+    std::optional<uint64_t> offset = getOutputOffset(*section, entry);
+    if (!offset) {
+      error(entry, "function " + name + " is not in the contents of " +
+                       section->section->getName());
+      continue;
+    }
+    Elf64_Sym sym{};
+    sym.st_name = symbolNames.add(name);
+    sym.st_info = ELF64_ST_INFO(STB_GLOBAL, STT_FUNC);
+    sym.st_shndx = section->index;
+    sym.st_value = *offset;
+    globalSymbolIndex[name] = static_cast<uint32_t>(globalSymbols.size());
+    globalSymbols.push_back(sym);
+    definedGlobals.emplace(entry, name);
+  }
+
+  // The remaining defined symbols are local labels.
+  for (const gtirb::Symbol& symbol : module.symbols()) {
+    if (!symbol.getAddress() || symbol.getName().empty())
+      continue;
+    gtirb::Addr addr = *symbol.getAddress();
+    if (isSkipped(addr) || definedGlobals.count({addr, symbol.getName()}))
+      continue;
+    OutputSection* section = getOutputSection(addr);
+    if (!section)
+      continue;
+    std::optional<uint64_t> offset = getOutputOffset(*section, addr);
+    if (!offset)
+      continue;
+    Elf64_Sym sym{};
+    sym.st_name = symbolNames.add(symbol.getName());
+    sym.st_info = ELF64_ST_INFO(
+        STB_LOCAL, (section->flags & SHF_TLS) ? STT_TLS : STT_NOTYPE);
+    sym.st_shndx = section->index;
+    sym.st_value = *offset;
+    localSymbols.push_back(sym);
+  }
+}
+
+SymbolRef ElfObjectWriter::getGlobalSymbol(const std::string& name) {
+  auto [it, inserted] = globalSymbolIndex.emplace(
+      name, static_cast<uint32_t>(globalSymbols.size()));
+  if (inserted) {
+    Elf64_Sym sym{};
+    sym.st_name = symbolNames.add(name);
+    sym.st_info = ELF64_ST_INFO(STB_GLOBAL, STT_NOTYPE);
+    sym.st_shndx = SHN_UNDEF;
+    globalSymbols.push_back(sym);
+  }
+  return {true, it->second};
+}
+
+Target ElfObjectWriter::resolve(const gtirb::Symbol& symbol, bool inData) {
+  Target target;
+  // Forwarded symbols (e.g. PLT and GOT entries) refer to the destination
+  // symbol, which is defined elsewhere.
+  if (const auto* symbolForwarding = prepared.getSymbolForwarding()) {
+    auto found = symbolForwarding->find(symbol.getUUID());
+    if (found != symbolForwarding->end()) {
+      if (const auto* dest = nodeFromUUID<gtirb::Symbol>(
+              prepared.getContext(), found->second)) {
+        target.symbol = getGlobalSymbol(dest->getName());
+        if (symbol.getAddress()) {
+          auto containers = module.findSection(*symbol.getAddress());
+          if (containers.begin() != containers.end()) {
+            const std::string& name = containers.begin()->getName();
+            target.plt = !inData && (name == ".plt" || name == ".plt.got");
+            target.got = name == ".got" || name == ".got.plt";
+          }
+        }
+        return target;
+      }
+    }
+  }
+
+  if (!symbol.getAddress()) {
+    target.symbol = getGlobalSymbol(symbol.getName());
+    return target;
+  }
+
+  gtirb::Addr addr = *symbol.getAddress();
+  if (OutputSection* section = getOutputSection(addr)) {
+    target.tls = (section->flags & SHF_TLS) != 0;
+    if (std::optional<uint64_t> offset = getOutputOffset(*section, addr)) {
+      target.symbol = section->symbol;
+      target.addend = static_cast<int64_t>(*offset);
+      return target;
+    }
+  } else {
+    auto containers = module.findSection(addr);
+    if (containers.begin() != containers.end())
+      target.tls = (getSectionProperties(*containers.begin()).second &
+                    SHF_TLS) != 0;
+  }
+
+  // The referenced address is not part of the object: refer to it as an
+  // absolute address, like the pretty printer does for skipped symbols.
+  target.addend = static_cast<int64_t>(static_cast<uint64_t>(addr));
+  return target;
+}
+
+void ElfObjectWriter::addRelocation(OutputSection& section, gtirb::Addr place,
+                                    uint64_t size, bool pcRelative,
+                                    bool signExtended, int64_t bias,
+                                    const gtirb::Symbol& symbol, int64_t offset,
+                                    bool inData) {
+  std::optional<uint64_t> placeOffset = getOutputOffset(section, place);
+  if (!placeOffset)
+    return;
+  Target target = resolve(symbol, inData);
+  // Thread-local variables are at an offset from the thread pointer, which
+  // needs TLS relocations that the pretty printer does not produce either.
+  if (target.tls) {
+    error(place, "cannot relocate a reference to the thread-local symbol " +
+                     symbol.getName());
+    return;
+  }
+
+  uint32_t type = R_X86_64_NONE;
+  if (pcRelative) {
+    if (size == 4)
+      type = target.got ? R_X86_64_GOTPCREL
+                        : (target.plt ? R_X86_64_PLT32 : R_X86_64_PC32);
+    else if (size == 8)
+      type = target.got ? R_X86_64_GOTPCREL64 : R_X86_64_PC64;
+    else if (target.symbol == section.symbol)
+      // Short displacements within the section are already correct, since
+      // the section is copied verbatim.
+      return;
+    else {
+      error(place, "cannot relocate a " + std::to_string(size) +
+                       "-byte pc-relative reference to " + symbol.getName());
+      return;
+    }
+  } else {
+    switch (size) {
+    case 8:
+      type = R_X86_64_64;
+      break;
+    case 4:
+      type = signExtended ? R_X86_64_32S : R_X86_64_32;
+      break;
+    case 2:
+      type = R_X86_64_16;
+      break;
+    case 1:
+      type = R_X86_64_8;
+      break;
+    default:
+      error(place, "unsupported reference size " + std::to_string(size) +
+                       " to " + symbol.getName());
+      return;
+    }
+    // The GOT entry holds the address of the symbol: referring to the symbol
+    // instead would read the code or data at that address.
+    if (target.got) {
+      error(place, "cannot relocate an absolute reference to the GOT entry " +
+                       symbol.getName());
+      return;
+    }
+  }
+  section.relocations.push_back(
+      {*placeOffset, type, target.symbol, target.addend + offset + bias});
+}
+
+void ElfObjectWriter::collectCodeRelocations() {
+  for (const gtirb::Block* block : prepared.getBlocks()) {
+    if (isSkipped(block->getAddress()))
+      continue;
+    OutputSection* section = getOutputSection(block->getAddress());
+    if (!section)
+      continue;
+    gtirb::ImageByteMap::const_range bytes =
+        getBytes(module.getImageByteMap(), *block);
+    if (bytes.empty())
+      continue;
+
+    cs_insn* insn;
+    size_t count =
+        cs_disasm(this->csHandle, reinterpret_cast<const uint8_t*>(&bytes[0]),
+                  bytes.size(), static_cast<uint64_t>(block->getAddress()), 0,
+                  &insn);
+
+    // Exception-safe cleanup of instructions
+    std::unique_ptr<cs_insn, std::function<void(cs_insn*)>> freeInsn(
+        insn, [count](cs_insn* i) { cs_free(i, count); });
+
+    for (size_t i = 0; i < count; i++)
+      addInstructionRelocations(*section, insn[i]);
+  }
+}
+
+void ElfObjectWriter::addInstructionRelocations(OutputSection& section,
+                                                const cs_insn& inst) {
+  const cs_x86& detail = inst.detail->x86;
+  gtirb::Addr ea(inst.address);
+  bool isBranch = cs_insn_group(this->csHandle, &inst, CS_GRP_CALL) ||
+                  cs_insn_group(this->csHandle, &inst, CS_GRP_JUMP);
+
+  std::set<uint8_t> done;
+  for (uint8_t i = 0; i < detail.op_count; i++) {
+    const cs_x86_op& op = detail.operands[i];
+    uint8_t fieldOffset = 0, fieldSize = 0;
+    bool pcRelative = false, signExtended = true;
+    if (op.type == X86_OP_IMM) {
+      fieldOffset = detail.encoding.imm_offset;
+      fieldSize = detail.encoding.imm_size;
+      pcRelative = isBranch;
+      signExtended = op.size == 8;
+    } else if (op.type == X86_OP_MEM) {
+      fieldOffset = detail.encoding.disp_offset;
+      fieldSize = detail.encoding.disp_size;
+      pcRelative = op.mem.base == X86_REG_RIP;
+    }
+    if (fieldOffset == 0 || !done.insert(fieldOffset).second)
+      continue;
+
+    auto found = module.findSymbolicExpression(ea + fieldOffset);
+    if (found == module.symbolic_expr_end())
+      continue;
+    const auto* s = std::get_if<gtirb::SymAddrConst>(&*found);
+    if (!s) {
+      error(ea, "symbolic operands must be 'address[+offset]'");
+      continue;
+    }
+    // PC-relative fields are relative to the end of the instruction.
+    int64_t bias =
+        pcRelative ? -static_cast<int64_t>(inst.size - fieldOffset) : 0;
+    addRelocation(section, ea + fieldOffset, fieldSize, pcRelative,
+                  signExtended, bias, *s->Sym, s->Offset, false);
+  }
+}
+
+void ElfObjectWriter::collectDataRelocations() {
+  for (const gtirb::DataObject* dataObject : prepared.getDataObjects()) {
+    gtirb::Addr addr = dataObject->getAddress();
+    if (isSkipped(addr))
+      continue;
+    OutputSection* section = getOutputSection(addr);
+    if (!section || section->type == SHT_NOBITS ||
+        !getOutputOffset(*section, addr))
+      continue;
+    auto found = module.findSymbolicExpression(addr);
+    if (found == module.symbolic_expr_end())
+      continue;
+
+    if (const auto* s = std::get_if<gtirb::SymAddrConst>(&*found)) {
+      addRelocation(*section, addr, dataObject->getSize(), false, false, 0,
+                    *s->Sym, s->Offset, true);
+    } else if (const auto* sa = std::get_if<gtirb::SymAddrAddr>(&*found)) {
+      // Sym1 - Sym2 is expressed as a pc-relative reference to Sym1, which
+      // requires Sym2 to keep its distance to the reference.
+      std::optional<gtirb::Addr> base = sa->Sym2->getAddress();
+      if (sa->Scale != 1 || !base || getOutputSection(*base) != section ||
+          !getOutputOffset(*section, *base)) {
+        error(addr, "unsupported symbol difference " + sa->Sym1->getName() +
+                        "-" + sa->Sym2->getName());
+        continue;
+      }
+      int64_t bias = static_cast<int64_t>(*getOutputOffset(*section, addr)) -
+                     static_cast<int64_t>(*getOutputOffset(*section, *base));
+      addRelocation(*section, addr, dataObject->getSize(), true, false, bias,
+                    *sa->Sym1, sa->Offset, true);
+    }
+  }
+}
+
+void ElfObjectWriter::writeFile(std::ostream& out) {
+  auto align = [](std::string& image, uint64_t alignment) {
+    while (image.size() % alignment != 0)
+      image.push_back('\0');
+  };
+  auto append = [](std::string& image, const auto& value) {
+    image.append(reinterpret_cast<const char*>(&value), sizeof(value));
+  };
+
+  StringTable sectionNames;
+  std::vector<Elf64_Shdr> headers(1, Elf64_Shdr{});
+  std::string image(sizeof(Elf64_Ehdr), '\0');
+
+  uint16_t symtabIndex = static_cast<uint16_t>(sections.size() + 1);
+  for (const OutputSection& section : sections)
+    if (!section.relocations.empty())
+      ++symtabIndex;
+
+  // Section contents.
+  for (const OutputSection& section : sections) {
+    Elf64_Shdr header{};
+    header.sh_name = sectionNames.add(section.section->getName());
+    header.sh_type = section.type;
+    header.sh_flags = section.flags;
+    header.sh_addralign = section.align;
+    header.sh_size = section.size;
+    if (section.type == SHT_INIT_ARRAY || section.type == SHT_FINI_ARRAY)
+      header.sh_entsize = 8;
+    align(image, section.align);
+    header.sh_offset = image.size();
+    image.append(section.contents.begin(), section.contents.end());
+    headers.push_back(header);
+  }
+
+  // Relocations.
+  for (const OutputSection& section : sections) {
+    if (section.relocations.empty())
+      continue;
+    Elf64_Shdr header{};
+    header.sh_name = sectionNames.add(".rela" + section.section->getName());
+    header.sh_type = SHT_RELA;
+    header.sh_flags = SHF_INFO_LINK;
+    header.sh_link = symtabIndex;
+    header.sh_info = section.index;
+    header.sh_addralign = 8;
+    header.sh_entsize = sizeof(Elf64_Rela);
+    align(image, 8);
+    header.sh_offset = image.size();
+    for (const Relocation& relocation : section.relocations) {
+      Elf64_Rela rela{};
+      rela.r_offset = relocation.offset;
+      rela.r_info = ELF64_R_INFO(getSymbolIndex(relocation.symbol),
+                                 relocation.type);
+      rela.r_addend = relocation.addend;
+      append(image, rela);
+    }
+    header.sh_size = image.size() - header.sh_offset;
+    headers.push_back(header);
+  }
+
+  // Symbol table, local symbols first.
+  Elf64_Shdr symtab{};
+  symtab.sh_name = sectionNames.add(".symtab");
+  symtab.sh_type = SHT_SYMTAB;
+  symtab.sh_link = symtabIndex + 1;
+  symtab.sh_info = static_cast<uint32_t>(localSymbols.size());
+  symtab.sh_addralign = 8;
+  symtab.sh_entsize = sizeof(Elf64_Sym);
+  align(image, 8);
+  symtab.sh_offset = image.size();
+  for (const Elf64_Sym& sym : localSymbols)
+    append(image, sym);
+  for (const Elf64_Sym& sym : globalSymbols)
+    append(image, sym);
+  symtab.sh_size = image.size() - symtab.sh_offset;
+  headers.push_back(symtab);
+
+  Elf64_Shdr strtab{};
+  strtab.sh_name = sectionNames.add(".strtab");
+  strtab.sh_type = SHT_STRTAB;
+  strtab.sh_addralign = 1;
+  strtab.sh_offset = image.size();
+  strtab.sh_size = symbolNames.data().size();
+  image += symbolNames.data();
+  headers.push_back(strtab);
+
+  Elf64_Shdr shstrtab{};
+  shstrtab.sh_name = sectionNames.add(".shstrtab");
+  shstrtab.sh_type = SHT_STRTAB;
+  shstrtab.sh_addralign = 1;
+  shstrtab.sh_offset = image.size();
+  shstrtab.sh_size = sectionNames.data().size();
+  image += sectionNames.data();
+  headers.push_back(shstrtab);
+
+  // Section header table.
+  align(image, 8);
+  uint64_t headersOffset = image.size();
+  for (const Elf64_Shdr& header : headers)
+    append(image, header);
+
+  Elf64_Ehdr ehdr{};
+  std::memcpy(ehdr.e_ident, ELFMAG, SELFMAG);
+  ehdr.e_ident[EI_CLASS] = ELFCLASS64;
+  ehdr.e_ident[EI_DATA] = ELFDATA2LSB;
+  ehdr.e_ident[EI_VERSION] = EV_CURRENT;
+  ehdr.e_ident[EI_OSABI] = ELFOSABI_SYSV;
+  ehdr.e_type = ET_REL;
+  ehdr.e_machine = EM_X86_64;
+  ehdr.e_version = EV_CURRENT;
+  ehdr.e_shoff = headersOffset;
+  ehdr.e_ehsize = sizeof(Elf64_Ehdr);
+  ehdr.e_shentsize = sizeof(Elf64_Shdr);
+  ehdr.e_shnum = static_cast<uint16_t>(headers.size());
+  ehdr.e_shstrndx = static_cast<uint16_t>(headers.size() - 1);
+  std::memcpy(&image[0], &ehdr, sizeof(ehdr));
+
+  out.write(image.data(), static_cast<std::streamsize>(image.size()));
+}
+
+} // namespace
+
+bool ElfObjectBinaryPrinter::writeObject(std::ostream& out,
+                                         const gtirb_pprint::PrettyPrinter& pp,
+                                         gtirb::Context& context,
+                                         gtirb::Module& module) const {
+  ElfObjectWriter writer(pp, context, module);
+  return writer.write(out);
+}
+
+int ElfObjectBinaryPrinter::link(
+    std::string outputFilename,
+    const std::vector<std::string>& extraCompilerArgs,
+    const std::vector<std::string>& userLibraryPaths,
+    const gtirb_pprint::PrettyPrinter& pp, gtirb::Context& ctx,
+    gtirb::IR& ir) const {
+  if (debug)
+    std::cout << "Generating binary file" << std::endl;
+  std::vector<std::unique_ptr<TempFile>> tempFiles;
+  std::vector<std::string> tempFileNames;
+  for (gtirb::Module& module : ir.modules()) {
+    tempFiles.push_back(std::make_unique<TempFile>(
+        ".o", std::ios_base::out | std::ios_base::binary));
+    TempFile& tempFile = *tempFiles.back();
+    if (!tempFile.fileStream) {
+      std::cerr << "ERROR: Could not write object into a temporary file.\n";
+      return -1;
+    }
+    if (debug)
+      std::cout << "Writing module " << module.getName()
+                << " to temporary file " << tempFile.name << std::endl;
+    gtirb_pprint::trace::Span span("io", "write temporary file",
+                                   tempFile.name);
+    if (!writeObject(tempFile.fileStream, pp, ctx, module)) {
+      std::cerr << "ERROR: Could not write module " << module.getName()
+                << " as an object file.\n";
+      return -1;
+    }
+    tempFile.fileStream.close();
+    tempFileNames.push_back(tempFile.name);
+  }
+  return callCompiler(outputFilename, tempFileNames, extraCompilerArgs,
+                      userLibraryPaths, ir);
+}
+
+} // namespace gtirb_bprint
@@ -13,21 +13,19 @@
 //
 //===----------------------------------------------------------------------===//
 #include "ElfPrettyPrinter.hpp"
+#include "NumberFormat.hpp"
 
 #include <elf.h>
 
 namespace gtirb_pprint {
 
-ElfPrettyPrinter::ElfPrettyPrinter(gtirb::Context& context_,
-                                   gtirb::Module& module_,
+ElfPrettyPrinter::ElfPrettyPrinter(const PreparedModule& prepared_,
                                    const ElfSyntax& syntax_,
-                                   const PrintingPolicy& policy_)
-    : PrettyPrinterBase(context_, module_, syntax_, policy_),
+                                   const PrintingPolicy& policy_,
+                                   std::pmr::memory_resource* resource_)
+    : PrettyPrinterBase(prepared_, syntax_, policy_, resource_),
       elfSyntax(syntax_) {
-  if (module.getAuxData<std::map<
-          gtirb::Offset, std::vector<std::tuple<
-                             std::string, std::vector<int64_t>, gtirb::UUID>>>>(
-          "cfiDirectives")) {
+  if (prepared.getCFIDirectives()) {
     policy.skipSections.insert(".eh_frame");
   }
 }
@@ -57,9 +55,7 @@ void ElfPrettyPrinter::printSectionHeaderDirective(
 
 void ElfPrettyPrinter::printSectionProperties(std::ostream& os,
                                               const gtirb::Section& section) {
-  const auto* elfSectionProperties =
-      module.getAuxData<std::map<gtirb::UUID, std::tuple<uint64_t, uint64_t>>>(
-          "elfSectionProperties");
+  const auto* elfSectionProperties = prepared.getElfSectionProperties();
   if (!elfSectionProperties)
     return;
   auto sectionProperties = elfSectionProperties->find(section.getUUID());
@@ -89,7 +85,8 @@ void ElfPrettyPrinter::printFunctionHeader(std::ostream& os, gtirb::Addr addr) {
       syntax.formatFunctionName(this->getFunctionName(addr));
 
   if (!name.empty()) {
-    os << syntax.comment() << " BEGIN - Function Header\n";
+    if (!compact)
+      os << syntax.comment() << " BEGIN - Function Header\n";
     printBar(os, false);
 
     printAlignment(os, addr);
@@ -98,7 +95,8 @@ void ElfPrettyPrinter::printFunctionHeader(std::ostream& os, gtirb::Addr addr) {
     os << name << ":\n";
 
     printBar(os, false);
-    os << syntax.comment() << " END   - Function Header\n";
+    if (!compact)
+      os << syntax.comment() << " END   - Function Header\n";
   }
 }
 
@@ -106,10 +104,9 @@ void ElfPrettyPrinter::printFunctionFooter(std::ostream& /* os */,
                                            gtirb::Addr /* addr */) {}
 
 void ElfPrettyPrinter::printByte(std::ostream& os, std::byte byte) {
-  std::ios_base::fmtflags flags = os.flags();
-  os << syntax.byteData() << " 0x" << std::hex << static_cast<uint32_t>(byte)
-     << '\n';
-  os.flags(flags);
+  os << syntax.byteData() << " 0x";
+  number_format::writeHex(os, static_cast<uint8_t>(byte));
+  os << '\n';
 }
 
 void ElfPrettyPrinter::printFooter(std::ostream& /* os */){};
@@ -14,14 +14,16 @@
 //===----------------------------------------------------------------------===//
 
 #include "IntelPrettyPrinter.hpp"
+#include "AllocationStats.hpp"
+#include "NumberFormat.hpp"
 
 namespace gtirb_pprint {
 
-IntelPrettyPrinter::IntelPrettyPrinter(gtirb::Context& context_,
-                                       gtirb::Module& module_,
+IntelPrettyPrinter::IntelPrettyPrinter(const PreparedModule& prepared_,
                                        const IntelSyntax& syntax_,
-                                       const PrintingPolicy& policy_)
-    : ElfPrettyPrinter(context_, module_, syntax_, policy_),
+                                       const PrintingPolicy& policy_,
+                                       std::pmr::memory_resource* resource_)
+    : ElfPrettyPrinter(prepared_, syntax_, policy_, resource_),
       intelSyntax(syntax_) {}
 
 void IntelPrettyPrinter::printHeader(std::ostream& os) {
@@ -40,7 +42,7 @@ void IntelPrettyPrinter::printOpRegdirect(std::ostream& os,
                                           const cs_x86_op& op) {
   assert(op.type == X86_OP_REG &&
          "printOpRegdirect called without a register operand");
-  os << getRegisterName(op.reg);
+  os << registerName(op.reg);
 }
 
 void IntelPrettyPrinter::printOpImmediate(
@@ -60,7 +62,7 @@ void IntelPrettyPrinter::printOpImmediate(
     this->printSymbolicExpression(os, s, !is_call && !is_jump);
   } else {
     // The operand is just a number.
-    os << op.imm;
+    number_format::writeDecimal(os, op.imm);
   }
 }
 
@@ -73,24 +75,25 @@ void IntelPrettyPrinter::printOpIndirect(
          "printOpIndirect called without a memory operand");
   bool first = true;
 
-  if (std::optional<std::string> size = syntax.getSizeName(op.size * 8))
+  if (std::optional<std::string_view> size = syntax.getSizeName(op.size * 8))
     os << *size << " PTR ";
 
   if (op.mem.segment != X86_REG_INVALID)
-    os << getRegisterName(op.mem.segment) << ':';
+    os << registerName(op.mem.segment) << ':';
 
   os << '[';
 
   if (op.mem.base != X86_REG_INVALID) {
     first = false;
-    os << getRegisterName(op.mem.base);
+    os << registerName(op.mem.base);
   }
 
   if (op.mem.index != X86_REG_INVALID) {
     if (!first)
       os << '+';
     first = false;
-    os << getRegisterName(op.mem.index) << '*' << std::to_string(op.mem.scale);
+    os << registerName(op.mem.index) << '*';
+    number_format::writeDecimal(os, op.mem.scale);
   }
 
   if (const auto* s = std::get_if<gtirb::SymAddrConst>(symbolic)) {
@@ -102,17 +105,20 @@ void IntelPrettyPrinter::printOpIndirect(
   os << ']';
 }
 
+template class StaticPrettyPrinter<IntelPrettyPrinter>;
+
 const PrintingPolicy& IntelPrettyPrinterFactory::defaultPrintingPolicy() const {
   return ElfPrettyPrinter::defaultPrintingPolicy();
 }
 
 std::unique_ptr<PrettyPrinterBase>
-IntelPrettyPrinterFactory::create(gtirb::Context& gtirb_context,
-                                  gtirb::Module& module,
-                                  const PrintingPolicy& policy) {
+IntelPrettyPrinterFactory::create(const PreparedModule& prepared,
+                                  const PrintingPolicy& policy,
+                                  std::pmr::memory_resource* resource) {
   static const IntelSyntax syntax{};
-  return std::make_unique<IntelPrettyPrinter>(gtirb_context, module, syntax,
-                                              policy);
+  allocation_stats::Scope scope(allocation_stats::Phase::Setup);
+  return std::make_unique<StaticPrettyPrinter<IntelPrettyPrinter>>(
+      prepared, syntax, policy, resource);
 }
 
 volatile bool IntelPrettyPrinter::registered = registerPrinter(
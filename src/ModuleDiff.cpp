@@ -0,0 +1,249 @@
+//===- ModuleDiff.cpp -------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2019 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+#include "ModuleDiff.hpp"
+#include "ChunkGenerator.hpp"
+#include "Fnv.hpp"
+#include "NumberFormat.hpp"
+#include "Trace.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+namespace gtirb_pprint {
+
+namespace {
+struct Element {
+  const gtirb::Node* node;
+  bool isBlock;
+  gtirb::Addr address;
+  uint64_t hash;
+};
+
+uint64_t hashSymbol(uint64_t hash, const gtirb::Symbol* symbol) {
+  return symbol ? fnv::fnv1a(hash, symbol->getName()) : hash;
+}
+
+// Extend a hash with a symbolic expression: the symbols it refers to and its
+// constants, which do not change when the symbols move.
+uint64_t hashSymbolicExpression(uint64_t hash,
+                                const gtirb::SymbolicExpression& expr) {
+  if (const auto* s = std::get_if<gtirb::SymAddrConst>(&expr)) {
+    hash = hashSymbol(hash, s->Sym);
+    return fnv::fnv1a(hash, &s->Offset, sizeof(s->Offset));
+  }
+  if (const auto* s = std::get_if<gtirb::SymAddrAddr>(&expr)) {
+    hash = hashSymbol(hashSymbol(hash, s->Sym1), s->Sym2);
+    hash = fnv::fnv1a(hash, &s->Scale, sizeof(s->Scale));
+    return fnv::fnv1a(hash, &s->Offset, sizeof(s->Offset));
+  }
+  if (const auto* s = std::get_if<gtirb::SymStackConst>(&expr)) {
+    hash = hashSymbol(hash, s->Sym);
+    return fnv::fnv1a(hash, &s->Offset, sizeof(s->Offset));
+  }
+  return hash;
+}
+
+// Hash an element: its size, every symbolic expression in it with its
+// offset, and its bytes. A data object starting with a symbolic expression is
+// printed from the expression alone, so its bytes, which change when the
+// symbol moves, are not hashed.
+template <class T>
+uint64_t hashElement(const gtirb::Module& module, const T& element) {
+  uint64_t size = element.getSize();
+  uint64_t hash = fnv::fnv1a(fnv::OffsetBasis, &size, sizeof(size));
+  bool symbolicStart = false;
+  for (uint64_t offset = 0; offset < size; ++offset) {
+    auto found = module.findSymbolicExpression(element.getAddress() + offset);
+    if (found == module.symbolic_expr_end())
+      continue;
+    hash = fnv::fnv1a(hash, &offset, sizeof(offset));
+    hash = hashSymbolicExpression(hash, *found);
+    if (offset == 0)
+      symbolicStart = true;
+  }
+  if (std::is_same_v<T, gtirb::DataObject> && symbolicStart)
+    return hash;
+  auto bytes = getBytes(module.getImageByteMap(), element);
+  return bytes.empty() ? hash : fnv::fnv1a(hash, &bytes[0], bytes.size());
+}
+
+std::vector<Element> hashElements(const PreparedModule& prepared) {
+  trace::Span span("diff", "hash module", prepared.getModule().getName());
+  const gtirb::Module& module = prepared.getModule();
+  std::vector<Element> elements;
+  elements.reserve(prepared.getBlocks().size() +
+                   prepared.getDataObjects().size());
+  for (const gtirb::Block* block : prepared.getBlocks())
+    elements.push_back(Element{block, true, block->getAddress(),
+                               hashElement(module, *block)});
+  for (const gtirb::DataObject* dataObject : prepared.getDataObjects())
+    elements.push_back(Element{dataObject, false, dataObject->getAddress(),
+                               hashElement(module, *dataObject)});
+  return elements;
+}
+
+// Format a single element: its function header and its instructions, or the
+// data object, without the section context printed before it.
+std::string formatElement(ChunkGenerator& chunks, const Element& element) {
+  chunks.seek(element.address);
+  std::string text;
+  while (std::optional<AssemblyChunk> chunk = chunks.next()) {
+    using Kind = AssemblyChunk::Kind;
+    if (chunk->kind == Kind::Header || chunk->kind == Kind::SectionHeader)
+      continue;
+    if (chunk->kind == Kind::Footer || chunk->address != element.address)
+      break;
+    bool blockChunk =
+        chunk->kind == Kind::FunctionHeader || chunk->kind == Kind::Block;
+    if (blockChunk == element.isBlock)
+      text += chunk->text;
+  }
+  return text;
+}
+
+void printLines(std::ostream& os, char prefix, const std::string& text) {
+  std::size_t begin = 0;
+  while (begin < text.size()) {
+    std::size_t end = text.find('\n', begin);
+    if (end == std::string::npos)
+      end = text.size();
+    os << prefix;
+    os.write(text.data() + begin, static_cast<std::streamsize>(end - begin));
+    os << '\n';
+    begin = end + 1;
+  }
+}
+
+std::string formatAddress(gtirb::Addr addr) {
+  return "0x" + number_format::toHex(static_cast<uint64_t>(addr));
+}
+} // namespace
+
+DiffSummary printDiff(std::ostream& os, const PrettyPrinter& printer,
+                      const PreparedModule& from, const PreparedModule& to) {
+  std::vector<Element> oldElements = hashElements(from);
+  std::vector<Element> newElements = hashElements(to);
+
+  // Match by UUID first.
+  std::map<gtirb::UUID, std::size_t> newByUUID;
+  for (std::size_t i = 0; i < newElements.size(); ++i)
+    newByUUID.emplace(newElements[i].node->getUUID(), i);
+  std::vector<std::optional<std::size_t>> oldMatch(oldElements.size());
+  std::vector<bool> newMatched(newElements.size(), false);
+  for (std::size_t i = 0; i < oldElements.size(); ++i) {
+    auto found = newByUUID.find(oldElements[i].node->getUUID());
+    if (found == newByUUID.end() ||
+        newElements[found->second].isBlock != oldElements[i].isBlock)
+      continue;
+    oldMatch[i] = found->second;
+    newMatched[found->second] = true;
+  }
+
+  // Then match the remaining elements by content: these only moved.
+  DiffSummary summary;
+  std::multimap<std::tuple<bool, uint64_t>, std::size_t> newByHash;
+  for (std::size_t i = 0; i < newElements.size(); ++i)
+    if (!newMatched[i])
+      newByHash.emplace(
+          std::make_tuple(newElements[i].isBlock, newElements[i].hash), i);
+  std::vector<bool> oldMoved(oldElements.size(), false);
+  for (std::size_t i = 0; i < oldElements.size(); ++i) {
+    if (oldMatch[i])
+      continue;
+    auto found = newByHash.find(
+        std::make_tuple(oldElements[i].isBlock, oldElements[i].hash));
+    if (found == newByHash.end())
+      continue;
+    newMatched[found->second] = true;
+    newByHash.erase(found);
+    oldMoved[i] = true;
+    ++summary.unchanged;
+  }
+
+  // Only the elements reported, or matched by UUID with different bytes, are
+  // formatted.
+  ChunkGenerator oldChunks = printer.generate(from);
+  ChunkGenerator newChunks = printer.generate(to);
+  struct Entry {
+    gtirb::Addr address;
+    std::string header;
+    std::string oldText;
+    std::string newText;
+  };
+  std::vector<Entry> entries;
+  auto describe = [](const char* change, const Element& element) {
+    return std::string(change) +
+           (element.isBlock ? " block " : " data object ") +
+           formatAddress(element.address);
+  };
+  for (std::size_t i = 0; i < oldElements.size(); ++i) {
+    const Element& oldElement = oldElements[i];
+    if (oldMoved[i])
+      continue;
+    if (!oldMatch[i]) {
+      ++summary.removed;
+      entries.push_back(Entry{oldElement.address,
+                              describe("removed", oldElement),
+                              formatElement(oldChunks, oldElement), ""});
+      continue;
+    }
+    const Element& newElement = newElements[*oldMatch[i]];
+    if (oldElement.hash == newElement.hash) {
+      ++summary.unchanged;
+      continue;
+    }
+    // The bytes of instructions may change only because they moved.
+    std::string oldText = formatElement(oldChunks, oldElement);
+    std::string newText = formatElement(newChunks, newElement);
+    if (oldText == newText) {
+      ++summary.unchanged;
+      continue;
+    }
+    ++summary.changed;
+    entries.push_back(Entry{newElement.address,
+                            describe("changed", oldElement) + " -> " +
+                                formatAddress(newElement.address),
+                            std::move(oldText), std::move(newText)});
+  }
+  for (std::size_t i = 0; i < newElements.size(); ++i) {
+    if (newMatched[i])
+      continue;
+    ++summary.added;
+    entries.push_back(Entry{newElements[i].address,
+                            describe("added", newElements[i]), "",
+                            formatElement(newChunks, newElements[i])});
+  }
+
+  std::stable_sort(entries.begin(), entries.end(),
+                   [](const Entry& a, const Entry& b) {
+                     return a.address < b.address;
+                   });
+  for (const Entry& entry : entries) {
+    os << "@@ " << entry.header << '\n';
+    printLines(os, '-', entry.oldText);
+    printLines(os, '+', entry.newText);
+  }
+  return summary;
+}
+
+} // namespace gtirb_pprint
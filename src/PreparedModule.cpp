@@ -0,0 +1,465 @@
+//===- PreparedModule.cpp ---------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2019 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+#include "PreparedModule.hpp"
+#include "AllocationStats.hpp"
+#include "Trace.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <tuple>
+#include <utility>
+
+template <class T> T* nodeFromUUID(gtirb::Context& C, gtirb::UUID id) {
+  return dyn_cast_or_null<T>(gtirb::Node::getByUUID(C, id));
+}
+
+namespace gtirb_pprint {
+
+namespace {
+// Order blocks by address with a least-significant-digit radix sort on 16-bit
+// digits. The digits shared by all the addresses are skipped, so a module
+// spanning less than 4GB takes at most two passes.
+void sortByAddress(std::pmr::vector<const gtirb::Block*>& blocks) {
+  auto byAddress = [](const gtirb::Block* a, const gtirb::Block* b) {
+    return a->getAddress() < b->getAddress();
+  };
+  if (std::is_sorted(blocks.begin(), blocks.end(), byAddress))
+    return;
+
+  using Keyed = std::pair<uint64_t, const gtirb::Block*>;
+  std::pmr::memory_resource* resource = blocks.get_allocator().resource();
+  std::pmr::vector<Keyed> keyed(resource);
+  keyed.reserve(blocks.size());
+  uint64_t anyBits = 0, allBits = ~uint64_t{0};
+  for (const gtirb::Block* block : blocks) {
+    uint64_t key = static_cast<uint64_t>(block->getAddress());
+    keyed.emplace_back(key, block);
+    anyBits |= key;
+    allBits &= key;
+  }
+  uint64_t varying = anyBits ^ allBits;
+
+  constexpr unsigned DigitBits = 16;
+  constexpr uint64_t DigitMask = (uint64_t{1} << DigitBits) - 1;
+  std::pmr::vector<Keyed> sorted(keyed.size(), resource);
+  std::pmr::vector<size_t> counts(DigitMask + 1, resource);
+  for (unsigned shift = 0; shift < 64; shift += DigitBits) {
+    if (((varying >> shift) & DigitMask) == 0)
+      continue;
+    std::fill(counts.begin(), counts.end(), 0);
+    for (const Keyed& k : keyed)
+      ++counts[(k.first >> shift) & DigitMask];
+    size_t total = 0;
+    for (size_t& count : counts)
+      total += std::exchange(count, total);
+    for (const Keyed& k : keyed)
+      sorted[counts[(k.first >> shift) & DigitMask]++] = k;
+    keyed.swap(sorted);
+  }
+  for (size_t i = 0; i < keyed.size(); ++i)
+    blocks[i] = keyed[i].second;
+}
+
+// Order data objects by address. They normally are already.
+void sortByAddress(std::pmr::vector<const gtirb::DataObject*>& dataObjects) {
+  auto byAddress = [](const gtirb::DataObject* a, const gtirb::DataObject* b) {
+    return a->getAddress() < b->getAddress();
+  };
+  if (!std::is_sorted(dataObjects.begin(), dataObjects.end(), byAddress))
+    std::stable_sort(dataObjects.begin(), dataObjects.end(), byAddress);
+}
+
+using FunctionTable = std::map<gtirb::UUID, std::set<gtirb::UUID>>;
+
+// Append the addresses of the entries of all the functions, in increasing
+// order.
+void addAllEntries(gtirb::Context& context, const FunctionTable* entries,
+                   std::pmr::vector<gtirb::Addr>& addrs) {
+  if (entries) {
+    for (auto const& function : *entries) {
+      for (auto& entryBlockUUID : function.second) {
+        const auto* block = nodeFromUUID<gtirb::Block>(context, entryBlockUUID);
+        assert(block && "UUID references non-existent block.");
+        if (block)
+          addrs.push_back(block->getAddress());
+      }
+    }
+  }
+  std::sort(addrs.begin(), addrs.end());
+  addrs.erase(std::unique(addrs.begin(), addrs.end()), addrs.end());
+}
+
+// Append the addresses of the entries of a function.
+void addEntries(gtirb::Context& context, const FunctionTable* entries,
+                const gtirb::UUID& function,
+                std::pmr::vector<gtirb::Addr>& addrs) {
+  if (!entries)
+    return;
+  auto found = entries->find(function);
+  if (found != entries->end())
+    for (auto& entryBlockUUID : found->second)
+      if (const auto* block =
+              nodeFromUUID<gtirb::Block>(context, entryBlockUUID))
+        addrs.push_back(block->getAddress());
+}
+} // namespace
+
+AddressIndex::AddressIndex(gtirb::Context& context_, gtirb::Module& module_,
+                           std::pmr::memory_resource* resource)
+    : context(context_), module(module_), blocks(resource),
+      dataObjects(resource), functionEntries(resource),
+      functionLastBlocks(resource), functionBlocks(resource),
+      functionEntryLists(resource) {
+  allocation_stats::Scope scope(allocation_stats::Phase::Setup);
+  trace::Span span("print", "index module", module.getName());
+
+  blocks.reserve(num_vertices(module.getCFG()));
+  for (const gtirb::Block& block : gtirb::blocks(module.getCFG()))
+    blocks.push_back(&block);
+  sortByAddress(blocks);
+  for (auto it = module.data_begin(); it != module.data_end(); ++it)
+    dataObjects.push_back(&*it);
+  sortByAddress(dataObjects);
+
+  const auto* entries = module.getAuxData<FunctionTable>("functionEntries");
+  addAllEntries(context, entries, functionEntries);
+
+  if (const auto* table = module.getAuxData<FunctionTable>("functionBlocks")) {
+    for (auto const& function : *table) {
+      assert(function.second.size() > 0);
+      size_t index = functionEntryLists.size();
+      addEntries(context, entries, function.first,
+                 functionEntryLists.emplace_back());
+      gtirb::Addr lastAddr{0};
+      for (auto& blockUUID : function.second) {
+        const auto* block = nodeFromUUID<gtirb::Block>(context, blockUUID);
+        assert(block && "UUID references non-existent block.");
+        if (!block)
+          continue;
+        functionBlocks.push_back(
+            FunctionBlock{block->getAddress(), index, block});
+        if (block->getAddress() > lastAddr)
+          lastAddr = block->getAddress();
+      }
+      functionLastBlocks.push_back(lastAddr);
+    }
+  }
+
+  std::sort(functionLastBlocks.begin(), functionLastBlocks.end());
+  functionLastBlocks.erase(
+      std::unique(functionLastBlocks.begin(), functionLastBlocks.end()),
+      functionLastBlocks.end());
+  std::sort(functionBlocks.begin(), functionBlocks.end(),
+            [](const FunctionBlock& a, const FunctionBlock& b) {
+              return std::tie(a.address, a.function) <
+                     std::tie(b.address, b.function);
+            });
+}
+
+PreparedModule::PreparedModule(Empty, gtirb::Context& context_,
+                               gtirb::Module& module_,
+                               std::pmr::memory_resource* resource_)
+    : context(context_), module(module_), resource(resource_),
+      functionEntries(resource), functionLastBlocks(resource),
+      moduleFunctionEntries(&ownModuleFunctionEntries),
+      ownModuleFunctionEntries(resource), functions(resource),
+      blocks(resource), dataObjects(resource),
+      comments(module.getAuxData<aux::Comments>("comments")),
+      cfiDirectives(module.getAuxData<aux::CFIDirectives>("cfiDirectives")),
+      encodings(module.getAuxData<aux::Encodings>("encodings")),
+      symbolForwarding(
+          module.getAuxData<aux::SymbolForwarding>("symbolForwarding")),
+      elfSectionProperties(module.getAuxData<aux::ElfSectionProperties>(
+          "elfSectionProperties")) {}
+
+PreparedModule::PreparedModule(gtirb::Context& context_,
+                               gtirb::Module& module_,
+                               std::pmr::memory_resource* resource_)
+    : PreparedModule(Empty{}, context_, module_, resource_) {
+  allocation_stats::Scope scope(allocation_stats::Phase::Setup);
+  trace::Span span("print", "prepare module", module.getName());
+
+  const auto* entries = module.getAuxData<FunctionTable>("functionEntries");
+  if (entries) {
+    for (auto const& function : *entries) {
+      for (auto& entryBlockUUID : function.second) {
+        const auto* block = nodeFromUUID<gtirb::Block>(context, entryBlockUUID);
+        assert(block && "UUID references non-existent block.");
+        if (block)
+          functionEntries.insert(block->getAddress());
+      }
+    }
+  }
+  ownModuleFunctionEntries.assign(functionEntries.begin(),
+                                  functionEntries.end());
+
+  if (const auto* functionBlocks =
+          module.getAuxData<FunctionTable>("functionBlocks")) {
+    for (auto const& function : *functionBlocks) {
+      assert(function.second.size() > 0);
+      Function& info = functions.emplace_back(
+          Function{std::pmr::vector<gtirb::Addr>(resource),
+                   std::pmr::vector<const gtirb::Block*>(resource)});
+      gtirb::Addr lastAddr{0};
+      for (auto& blockUUID : function.second) {
+        const auto* block = nodeFromUUID<gtirb::Block>(context, blockUUID);
+        assert(block && "UUID references non-existent block.");
+        if (!block)
+          continue;
+        info.blocks.push_back(block);
+        if (block->getAddress() > lastAddr)
+          lastAddr = block->getAddress();
+      }
+      functionLastBlocks.insert(lastAddr);
+      addEntries(context, entries, function.first, info.entries);
+    }
+  }
+
+  // FIXME: simplify once block interation order is guaranteed by gtirb
+  blocks.reserve(num_vertices(module.getCFG()));
+  for (const gtirb::Block& block : gtirb::blocks(module.getCFG()))
+    blocks.push_back(&block);
+  sortByAddress(blocks);
+  for (auto it = module.data_begin(); it != module.data_end(); ++it)
+    dataObjects.push_back(&*it);
+}
+
+PreparedModule::PreparedModule(gtirb::Context& context_,
+                               gtirb::Module& module_, gtirb::Addr start,
+                               gtirb::Addr end,
+                               std::pmr::memory_resource* resource_)
+    : PreparedModule(Empty{}, context_, module_, resource_) {
+  allocation_stats::Scope scope(allocation_stats::Phase::Setup);
+  trace::Span span("print", "prepare range", module.getName());
+  auto inRange = [&](gtirb::Addr addr) { return start <= addr && addr < end; };
+
+  // The CFG does not order its blocks, so they are selected by address. The
+  // UUIDs of the selected blocks then tell which functions to resolve.
+  for (const gtirb::Block& block : gtirb::blocks(module.getCFG()))
+    if (inRange(block.getAddress()))
+      blocks.push_back(&block);
+  sortByAddress(blocks);
+  using BlockId = std::pair<gtirb::UUID, const gtirb::Block*>;
+  std::pmr::vector<BlockId> blockIds(resource);
+  blockIds.reserve(blocks.size());
+  for (const gtirb::Block* block : blocks)
+    blockIds.emplace_back(block->getUUID(), block);
+  std::sort(blockIds.begin(), blockIds.end());
+  auto findInRange = [&](const gtirb::UUID& id) -> const gtirb::Block* {
+    auto found = std::lower_bound(
+        blockIds.begin(), blockIds.end(), id,
+        [](const BlockId& x, const gtirb::UUID& y) { return x.first < y; });
+    return found != blockIds.end() && found->first == id ? found->second
+                                                         : nullptr;
+  };
+
+  const auto* entries = module.getAuxData<FunctionTable>("functionEntries");
+  if (entries) {
+    std::optional<gtirb::Addr> entryBefore;
+    for (auto const& function : *entries) {
+      for (auto& entryBlockUUID : function.second) {
+        if (const gtirb::Block* block = findInRange(entryBlockUUID)) {
+          functionEntries.insert(block->getAddress());
+          ownModuleFunctionEntries.push_back(block->getAddress());
+          continue;
+        }
+        const auto* block = nodeFromUUID<gtirb::Block>(context, entryBlockUUID);
+        assert(block && "UUID references non-existent block.");
+        if (!block)
+          continue;
+        ownModuleFunctionEntries.push_back(block->getAddress());
+        if (block->getAddress() < start &&
+            (!entryBefore || *entryBefore < block->getAddress()))
+          entryBefore = block->getAddress();
+      }
+    }
+    if (entryBefore)
+      functionEntries.insert(*entryBefore);
+    std::sort(ownModuleFunctionEntries.begin(),
+              ownModuleFunctionEntries.end());
+    ownModuleFunctionEntries.erase(
+        std::unique(ownModuleFunctionEntries.begin(),
+                    ownModuleFunctionEntries.end()),
+        ownModuleFunctionEntries.end());
+  }
+
+  if (const auto* functionBlocks =
+          module.getAuxData<FunctionTable>("functionBlocks")) {
+    for (auto const& function : *functionBlocks) {
+      assert(function.second.size() > 0);
+      if (std::none_of(function.second.begin(), function.second.end(),
+                       findInRange))
+        continue;
+      Function& info = functions.emplace_back(
+          Function{std::pmr::vector<gtirb::Addr>(resource),
+                   std::pmr::vector<const gtirb::Block*>(resource)});
+      gtirb::Addr lastAddr{0};
+      for (auto& blockUUID : function.second) {
+        const gtirb::Block* block = findInRange(blockUUID);
+        if (block)
+          info.blocks.push_back(block);
+        else
+          block = nodeFromUUID<gtirb::Block>(context, blockUUID);
+        assert(block && "UUID references non-existent block.");
+        if (block && block->getAddress() > lastAddr)
+          lastAddr = block->getAddress();
+      }
+      if (inRange(lastAddr))
+        functionLastBlocks.insert(lastAddr);
+      addEntries(context, entries, function.first, info.entries);
+    }
+  }
+
+  for (auto it = module.data_begin(); it != module.data_end(); ++it)
+    if (inRange(it->getAddress()))
+      dataObjects.push_back(&*it);
+  sortByAddress(dataObjects);
+}
+
+PreparedModule::PreparedModule(const AddressIndex& index, gtirb::Addr start,
+                               gtirb::Addr end,
+                               std::pmr::memory_resource* resource_)
+    : PreparedModule(Empty{}, index.getContext(), index.getModule(),
+                     resource_) {
+  allocation_stats::Scope scope(allocation_stats::Phase::Setup);
+  trace::Span span("print", "prepare range", module.getName());
+  moduleFunctionEntries = &index.functionEntries;
+  auto byAddress = [](const auto* x, gtirb::Addr a) {
+    return x->getAddress() < a;
+  };
+  auto blockIt = std::lower_bound(index.blocks.begin(), index.blocks.end(),
+                                  start, byAddress);
+  blocks.assign(blockIt, std::lower_bound(blockIt, index.blocks.end(), end,
+                                          byAddress));
+  auto dataIt = std::lower_bound(index.dataObjects.begin(),
+                                 index.dataObjects.end(), start, byAddress);
+  dataObjects.assign(dataIt, std::lower_bound(dataIt, index.dataObjects.end(),
+                                              end, byAddress));
+
+  auto entryIt = std::lower_bound(index.functionEntries.begin(),
+                                  index.functionEntries.end(), start);
+  if (entryIt != index.functionEntries.begin())
+    functionEntries.insert(*std::prev(entryIt));
+  functionEntries.insert(
+      entryIt,
+      std::lower_bound(entryIt, index.functionEntries.end(), end));
+  auto lastIt = std::lower_bound(index.functionLastBlocks.begin(),
+                                 index.functionLastBlocks.end(), start);
+  functionLastBlocks.insert(
+      lastIt, std::lower_bound(lastIt, index.functionLastBlocks.end(), end));
+
+  // Gather the blocks in the range by function, in the order of the first
+  // block of each function.
+  auto functionBlockIt = std::lower_bound(
+      index.functionBlocks.begin(), index.functionBlocks.end(), start,
+      [](const AddressIndex::FunctionBlock& x, gtirb::Addr a) {
+        return x.address < a;
+      });
+  std::pmr::map<size_t, size_t> positions(resource);
+  for (; functionBlockIt != index.functionBlocks.end() &&
+         functionBlockIt->address < end;
+       ++functionBlockIt) {
+    auto [position, inserted] =
+        positions.try_emplace(functionBlockIt->function, functions.size());
+    if (inserted) {
+      const auto& entryList =
+          index.functionEntryLists[functionBlockIt->function];
+      functions.emplace_back(Function{
+          std::pmr::vector<gtirb::Addr>(entryList.begin(), entryList.end(),
+                                        resource),
+          std::pmr::vector<const gtirb::Block*>(resource)});
+    }
+    functions[position->second].blocks.push_back(functionBlockIt->block);
+  }
+}
+
+PreparedModule::PreparedModule(gtirb::Context& context_,
+                               gtirb::Module& module_,
+                               const std::vector<gtirb::UUID>& functionIds,
+                               std::pmr::memory_resource* resource_)
+    : PreparedModule(Empty{}, context_, module_, resource_) {
+  allocation_stats::Scope scope(allocation_stats::Phase::Setup);
+  trace::Span span("print", "prepare functions", module.getName());
+  const auto* entries = module.getAuxData<FunctionTable>("functionEntries");
+  addAllEntries(context, entries, ownModuleFunctionEntries);
+  const auto* functionBlocks =
+      module.getAuxData<FunctionTable>("functionBlocks");
+  if (!functionBlocks)
+    return;
+  for (const gtirb::UUID& id : functionIds) {
+    auto found = functionBlocks->find(id);
+    if (found == functionBlocks->end())
+      continue;
+    Function& info = functions.emplace_back(
+        Function{std::pmr::vector<gtirb::Addr>(resource),
+                 std::pmr::vector<const gtirb::Block*>(resource)});
+    gtirb::Addr lastAddr{0};
+    for (auto& blockUUID : found->second) {
+      const auto* block = nodeFromUUID<gtirb::Block>(context, blockUUID);
+      assert(block && "UUID references non-existent block.");
+      if (!block)
+        continue;
+      info.blocks.push_back(block);
+      blocks.push_back(block);
+      if (block->getAddress() > lastAddr)
+        lastAddr = block->getAddress();
+    }
+    functionLastBlocks.insert(lastAddr);
+    addEntries(context, entries, id, info.entries);
+    functionEntries.insert(info.entries.begin(), info.entries.end());
+  }
+  // Functions may share blocks.
+  sortByAddress(blocks);
+  blocks.erase(std::unique(blocks.begin(), blocks.end()), blocks.end());
+}
+
+std::vector<gtirb::UUID>
+PreparedModule::findFunctions(gtirb::Context& context,
+                              const gtirb::Module& module,
+                              const std::string& name) {
+  std::vector<gtirb::UUID> found;
+  std::vector<gtirb::Addr> addrs;
+  for (const gtirb::Symbol& symbol : module.findSymbols(name))
+    if (std::optional<gtirb::Addr> addr = symbol.getAddress())
+      addrs.push_back(*addr);
+  const auto* entries = module.getAuxData<FunctionTable>("functionEntries");
+  if (addrs.empty() || !entries)
+    return found;
+  for (auto const& function : *entries) {
+    bool named = std::any_of(
+        function.second.begin(), function.second.end(),
+        [&](const gtirb::UUID& entryBlockUUID) {
+          const auto* block =
+              nodeFromUUID<gtirb::Block>(context, entryBlockUUID);
+          return block && std::find(addrs.begin(), addrs.end(),
+                                    block->getAddress()) != addrs.end();
+        });
+    if (named)
+      found.push_back(function.first);
+  }
+  return found;
+}
+
+std::vector<gtirb::Addr> getSectionStarts(const gtirb::Module& module) {
+  std::vector<gtirb::Addr> starts{gtirb::Addr{0}};
+  for (const gtirb::Section& section : module.sections())
+    starts.push_back(section.getAddress());
+  std::sort(starts.begin(), starts.end());
+  starts.erase(std::unique(starts.begin(), starts.end()), starts.end());
+  return starts;
+}
+
+} // namespace gtirb_pprint
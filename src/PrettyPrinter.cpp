@@ -13,16 +13,29 @@
 //
 //===----------------------------------------------------------------------===//
 #include "PrettyPrinter.hpp"
+#include "AllocationStats.hpp"
+#include "ChunkGenerator.hpp"
+#include "NumberFormat.hpp"
 
+#include "Trace.hpp"
 #include "string_utils.hpp"
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/range/algorithm/find_if.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <capstone/capstone.h>
 #include <fstream>
 #include <gtirb/gtirb.hpp>
 #include <iomanip>
 #include <iostream>
+#include <limits>
+#include <memory_resource>
+#include <mutex>
+#include <stdexcept>
+#include <system_error>
+#include <unordered_map>
 #include <utility>
 #include <variant>
 
@@ -30,20 +43,176 @@ template <class T> T* nodeFromUUID(gtirb::Context& C, gtirb::UUID id) {
   return dyn_cast_or_null<T>(gtirb::Node::getByUUID(C, id));
 }
 
-static std::map<std::tuple<std::string, std::string>,
-                std::shared_ptr<::gtirb_pprint::PrettyPrinterFactory>>&
-getFactories() {
-  static std::map<std::tuple<std::string, std::string>,
-                  std::shared_ptr<::gtirb_pprint::PrettyPrinterFactory>>
-      factories;
-  return factories;
+namespace {
+
+using FactoryMap =
+    std::map<std::tuple<std::string, std::string>,
+             std::shared_ptr<::gtirb_pprint::PrettyPrinterFactory>>;
+
+// A snapshot of the registered factories and default syntaxes. Snapshots are
+// never modified once published, so they can be read without locking.
+struct Registry {
+  FactoryMap factories;
+  std::map<std::string, std::string> syntaxes;
+};
+
+// Registration replaces the current snapshot with an updated copy. Replaced
+// snapshots are kept alive because readers may still be using them;
+// registration only happens a handful of times at startup.
+class RegistryState {
+public:
+  const Registry& get() const {
+    return *current.load(std::memory_order_acquire);
+  }
+
+  template <typename Update> void update(Update updateRegistry) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    auto next = std::make_unique<Registry>(get());
+    updateRegistry(*next);
+    current.store(next.get(), std::memory_order_release);
+    snapshots.push_back(std::move(next));
+  }
+
+  static RegistryState& instance() {
+    static RegistryState state;
+    return state;
+  }
+
+private:
+  RegistryState() {
+    snapshots.push_back(std::make_unique<Registry>());
+    current.store(snapshots.back().get(), std::memory_order_release);
+  }
+
+  std::atomic<const Registry*> current{nullptr};
+  std::mutex writeMutex;
+  std::vector<std::unique_ptr<Registry>> snapshots;
+};
+
+const FactoryMap& getFactories() {
+  return RegistryState::instance().get().factories;
 }
 
-static std::map<std::string, std::string>& getSyntaxes() {
-  static std::map<std::string, std::string> defaults;
-  return defaults;
+// Format an address in lower-case hexadecimal, without a prefix.
+std::string toHex(gtirb::Addr x) {
+  return ::gtirb_pprint::number_format::toHex(static_cast<uint64_t>(x));
 }
 
+std::unique_ptr<::gtirb_pprint::PrettyPrinterBase>
+createPrinter(::gtirb_pprint::PrettyPrinterFactory& factory,
+              const ::gtirb_pprint::PreparedModule& prepared,
+              const ::gtirb_pprint::PrintingPolicy& policy,
+              std::pmr::memory_resource* resource) {
+  ::gtirb_pprint::trace::Span span("print", "create printer");
+  return factory.create(prepared, policy, resource);
+}
+
+// Holds the output of a streaming print until a fixed number of bytes are
+// pending, then writes them to the destination.
+class BoundedBuffer : public std::streambuf {
+public:
+  BoundedBuffer(std::streambuf& destination_, std::size_t size)
+      : destination(destination_), buffer(std::max<std::size_t>(size, 1)) {
+    setp(buffer.data(), buffer.data() + buffer.size());
+  }
+
+  ~BoundedBuffer() override { sync(); }
+
+protected:
+  int overflow(int c) override {
+    if (!writePending())
+      return traits_type::eof();
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+      *pptr() = traits_type::to_char_type(c);
+      pbump(1);
+    }
+    return traits_type::not_eof(c);
+  }
+
+  int sync() override {
+    return writePending() && destination.pubsync() == 0 ? 0 : -1;
+  }
+
+private:
+  bool writePending() {
+    std::streamsize pending = pptr() - pbase();
+    bool written = destination.sputn(pbase(), pending) == pending;
+    setp(buffer.data(), buffer.data() + buffer.size());
+    return written;
+  }
+
+  std::streambuf& destination;
+  std::vector<char> buffer;
+};
+
+// Appends the output to a string, without a buffer of its own.
+class StringAppendBuffer : public std::streambuf {
+public:
+  explicit StringAppendBuffer(std::pmr::string& text_) : text(text_) {}
+
+protected:
+  int overflow(int c) override {
+    if (!traits_type::eq_int_type(c, traits_type::eof()))
+      text.push_back(traits_type::to_char_type(c));
+    return traits_type::not_eof(c);
+  }
+
+  std::streamsize xsputn(const char* s, std::streamsize n) override {
+    text.append(s, static_cast<std::size_t>(n));
+    return n;
+  }
+
+private:
+  std::pmr::string& text;
+};
+
+// The open Capstone handles not lent to any CapstoneHandle, by syntax.
+class CapstonePool {
+public:
+  static CapstonePool& instance() {
+    static CapstonePool pool;
+    return pool;
+  }
+
+  csh acquire(cs_opt_value syntax) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      std::vector<csh>& free = handles[syntax];
+      if (!free.empty()) {
+        csh handle = free.back();
+        free.pop_back();
+        return handle;
+      }
+    }
+    csh handle;
+    [[maybe_unused]] cs_err err = cs_open(CS_ARCH_X86, CS_MODE_64, &handle);
+    assert(err == CS_ERR_OK && "Capstone failure");
+    cs_option(handle, CS_OPT_DETAIL, CS_OPT_ON);
+    if (syntax != CS_OPT_SYNTAX_DEFAULT)
+      cs_option(handle, CS_OPT_SYNTAX, syntax);
+    return handle;
+  }
+
+  void release(cs_opt_value syntax, csh handle) {
+    std::lock_guard<std::mutex> lock(mutex);
+    handles[syntax].push_back(handle);
+  }
+
+private:
+  CapstonePool() = default;
+
+  ~CapstonePool() {
+    for (auto& [syntax, free] : handles)
+      for (csh& handle : free)
+        cs_close(&handle);
+  }
+
+  std::mutex mutex;
+  std::map<cs_opt_value, std::vector<csh>> handles;
+};
+
+} // namespace
+
 namespace gtirb_pprint {
 
 bool registerPrinter(std::initializer_list<std::string> formats,
@@ -51,13 +220,15 @@ bool registerPrinter(std::initializer_list<std::string> formats,
                      std::shared_ptr<PrettyPrinterFactory> f, bool isDefault) {
   assert(formats.size() > 0 && "No formats to register!");
   assert(syntaxes.size() > 0 && "No syntaxes to register!");
-  for (const std::string& format : formats) {
-    for (const std::string& syntax : syntaxes) {
-      getFactories()[std::make_tuple(format, syntax)] = std::move(f);
-      if (isDefault)
-        setDefaultSyntax(format, syntax);
+  RegistryState::instance().update([&](Registry& registry) {
+    for (const std::string& format : formats) {
+      for (const std::string& syntax : syntaxes) {
+        registry.factories[std::make_tuple(format, syntax)] = f;
+        if (isDefault)
+          registry.syntaxes[format] = syntax;
+      }
     }
-  }
+  });
   return true;
 }
 
@@ -92,15 +263,31 @@ std::string getModuleFileFormat(const gtirb::Module& module) {
 }
 
 void setDefaultSyntax(const std::string& format, const std::string& syntax) {
-  getSyntaxes()[format] = syntax;
+  RegistryState::instance().update(
+      [&](Registry& registry) { registry.syntaxes[format] = syntax; });
 }
 
 std::optional<std::string> getDefaultSyntax(const std::string& format) {
-  std::map<std::string, std::string> defaults = getSyntaxes();
+  const auto& defaults = RegistryState::instance().get().syntaxes;
   auto it = defaults.find(format);
   return it != defaults.end() ? std::make_optional(it->second) : std::nullopt;
 }
 
+std::tuple<std::string, std::string>
+resolveTarget(const gtirb::Module& module, const std::string& format,
+              const std::string& syntax) {
+  std::string targetFormat =
+      !format.empty() ? format : getModuleFileFormat(module);
+  std::string targetSyntax =
+      !syntax.empty() ? syntax : getDefaultSyntax(targetFormat).value_or("");
+  auto target = std::make_tuple(targetFormat, targetSyntax);
+  if (getFactories().count(target) == 0)
+    throw std::invalid_argument("unsupported combination: format '" +
+                                targetFormat + "' and syntax '" +
+                                targetSyntax + "'");
+  return target;
+}
+
 void PrettyPrinter::setTarget(
     const std::tuple<std::string, std::string>& target) {
   assert(getFactories().find(target) != getFactories().end());
@@ -120,6 +307,12 @@ void PrettyPrinter::setDebug(bool do_debug) {
 
 bool PrettyPrinter::getDebug() const { return m_debug == DebugMessages; }
 
+void PrettyPrinter::setCompact(bool do_compact) {
+  m_layout = do_compact ? CompactLayout : ReadableLayout;
+}
+
+bool PrettyPrinter::getCompact() const { return m_layout == CompactLayout; }
+
 void PrettyPrinter::skipFunction(const std::string& functionName) {
   m_skip_funcs.insert(functionName);
 }
@@ -128,75 +321,418 @@ void PrettyPrinter::keepFunction(const std::string& functionName) {
   m_keep_funcs.insert(functionName);
 }
 
-std::error_condition PrettyPrinter::print(std::ostream& stream,
-                                          gtirb::Context& context,
-                                          gtirb::Module& module) const {
-  // Find pretty printer factory.
+std::shared_ptr<PrettyPrinterFactory>
+PrettyPrinter::getFactory(const gtirb::Module& module) const {
   auto target = std::make_tuple(m_format, m_syntax);
   if (m_format.empty()) {
     const std::string& format = gtirb_pprint::getModuleFileFormat(module);
     const std::string& syntax = getDefaultSyntax(format).value_or("");
     target = std::make_tuple(format, syntax);
   }
-  const std::shared_ptr<PrettyPrinterFactory> factory =
-      getFactories().at(target);
+  return getFactories().at(target);
+}
 
-  // Configure printing policy.
-  PrintingPolicy policy(factory->defaultPrintingPolicy());
+PrintingPolicy PrettyPrinter::getPolicy(const gtirb::Module& module) const {
+  return getPolicy(*getFactory(module));
+}
+
+PrintingPolicy
+PrettyPrinter::getPolicy(const PrettyPrinterFactory& factory) const {
+  PrintingPolicy policy(factory.defaultPrintingPolicy());
   policy.debug = m_debug;
+  policy.layout = m_layout;
   for (auto& name : m_skip_funcs)
     policy.skipFunctions.insert(name);
   for (auto& name : m_keep_funcs)
     policy.skipFunctions.erase(name);
+  return policy;
+}
+
+std::error_condition
+PrettyPrinter::print(std::ostream& stream, gtirb::Context& context,
+                     gtirb::Module& module,
+                     std::pmr::memory_resource* resource) const {
+  return print(stream, PreparedModule(context, module, resource), resource);
+}
+
+std::error_condition
+PrettyPrinter::printStreaming(std::ostream& stream, gtirb::Context& context,
+                              gtirb::Module& module,
+                              std::size_t bufferSize) const {
+  const std::shared_ptr<PrettyPrinterFactory> factory = getFactory(module);
+  PrintingPolicy policy = getPolicy(*factory);
+
+  std::vector<gtirb::Addr> starts = getSectionStarts(module);
+
+  // The parts are prepared from one index, so that each part only visits
+  // its own elements, and share the skipped ranges of the whole module.
+  const AddressIndex index(context, module);
+  std::shared_ptr<const std::vector<AddrRange>> skippedRanges;
+  BoundedBuffer buffer(*stream.rdbuf(), bufferSize);
+  std::ostream os(&buffer);
+  gtirb::Addr last{0};
+  for (size_t i = 0; i < starts.size(); ++i) {
+    bool final = i + 1 == starts.size();
+    gtirb::Addr end =
+        final ? gtirb::Addr{std::numeric_limits<uint64_t>::max()}
+              : starts[i + 1];
+    trace::Span span("print", "print part", toHex(starts[i]));
+    std::pmr::monotonic_buffer_resource arena;
+    PreparedModule prepared(index, starts[i], end, &arena);
+    if (i != 0 && !final && prepared.getBlocks().empty() &&
+        prepared.getDataObjects().empty())
+      continue;
+    std::unique_ptr<PrettyPrinterBase> printer =
+        createPrinter(*factory, prepared, policy, &arena);
+    if (skippedRanges)
+      printer->setSkippedRanges(skippedRanges);
+    else
+      skippedRanges = printer->getSkippedRanges();
+    last = printer->printPart(os, last, i == 0, final);
+    os.flush();
+  }
+  if (!stream)
+    return std::make_error_condition(std::errc::io_error);
+
+  return std::error_condition{};
+}
+
+std::error_condition
+PrettyPrinter::print(std::ostream& stream, const PreparedModule& prepared,
+                     std::pmr::memory_resource* resource) const {
+  // Find pretty printer factory.
+  const std::shared_ptr<PrettyPrinterFactory> factory =
+      getFactory(prepared.getModule());
+
+  // Configure printing policy.
+  PrintingPolicy policy = getPolicy(prepared.getModule());
 
   // Create the pretty printer and print the IR.
-  factory->create(context, module, policy)->print(stream);
+  trace::Span span("print", "print module", prepared.getModule().getName());
+  std::pmr::unsynchronized_pool_resource pool(resource);
+  createPrinter(*factory, prepared, policy, &pool)->print(stream);
 
   return std::error_condition{};
 }
 
-PrettyPrinterBase::PrettyPrinterBase(gtirb::Context& context_,
-                                     gtirb::Module& module_,
-                                     const Syntax& syntax_,
-                                     const PrintingPolicy& policy_)
-    : syntax(syntax_), policy(policy_),
-      debug(policy.debug == DebugMessages ? true : false), context(context_),
-      module(module_), functionEntry(), functionLastBlock() {
-  [[maybe_unused]] cs_err err =
-      cs_open(CS_ARCH_X86, CS_MODE_64, &this->csHandle);
-  assert(err == CS_ERR_OK && "Capstone failure");
-
-  if (const auto* functionEntries =
-          module.getAuxData<std::map<gtirb::UUID, std::set<gtirb::UUID>>>(
-              "functionEntries")) {
-    for (auto const& function : *functionEntries) {
-      for (auto& entryBlockUUID : function.second) {
-        const auto* block = nodeFromUUID<gtirb::Block>(context, entryBlockUUID);
-        assert(block && "UUID references non-existent block.");
-        if (block)
-          functionEntry.insert(block->getAddress());
-      }
+std::error_condition
+PrettyPrinter::print(const std::vector<TargetStream>& targets,
+                     const PreparedModule& prepared) const {
+  trace::Span span("print", "print listings", prepared.getModule().getName());
+  // The printers run concurrently, so each has a resource of its own.
+  std::vector<std::unique_ptr<std::pmr::memory_resource>> resources;
+  std::vector<std::unique_ptr<PrettyPrinterBase>> printers;
+  std::vector<std::pair<PrettyPrinterBase*, std::ostream*>> streams;
+  for (const auto& [target, stream] : targets) {
+    const std::shared_ptr<PrettyPrinterFactory>& factory =
+        getFactories().at(target);
+    resources.push_back(
+        std::make_unique<std::pmr::unsynchronized_pool_resource>());
+    printers.push_back(createPrinter(*factory, prepared, getPolicy(*factory),
+                                     resources.back().get()));
+    streams.emplace_back(printers.back().get(), stream);
+  }
+  PrettyPrinterBase::printAll(streams);
+
+  return std::error_condition{};
+}
+
+std::unique_ptr<PrettyPrinterBase>
+PrettyPrinter::makePrinter(const PreparedModule& prepared,
+                           std::pmr::memory_resource* resource) const {
+  const std::shared_ptr<PrettyPrinterFactory> factory =
+      getFactory(prepared.getModule());
+  return createPrinter(*factory, prepared, getPolicy(*factory), resource);
+}
+
+ChunkGenerator PrettyPrinter::generate(gtirb::Context& context,
+                                       gtirb::Module& module) const {
+  const std::shared_ptr<PrettyPrinterFactory> factory = getFactory(module);
+  return ChunkGenerator(context, module, factory, getPolicy(*factory));
+}
+
+ChunkGenerator PrettyPrinter::generate(const PreparedModule& prepared) const {
+  const std::shared_ptr<PrettyPrinterFactory> factory =
+      getFactory(prepared.getModule());
+  auto resource = std::make_unique<std::pmr::unsynchronized_pool_resource>();
+  std::unique_ptr<PrettyPrinterBase> printer =
+      factory->create(prepared, getPolicy(*factory), resource.get());
+  return ChunkGenerator(std::move(resource), std::move(printer));
+}
+
+std::error_condition
+PrettyPrinter::printFunction(std::ostream& stream,
+                             const PreparedModule& prepared,
+                             const std::string& name) const {
+  const gtirb::Module& module = prepared.getModule();
+  std::vector<AddrRange> ranges;
+  for (const PreparedModule::Function& function : prepared.getFunctions()) {
+    bool named = std::any_of(
+        function.entries.begin(), function.entries.end(),
+        [&](gtirb::Addr entry) {
+          const auto symbols = module.findSymbols(entry);
+          return std::any_of(symbols.begin(), symbols.end(),
+                             [&](const gtirb::Symbol& symbol) {
+                               return symbol.getName() == name;
+                             });
+        });
+    if (!named)
+      continue;
+    for (const gtirb::Block* block : function.blocks)
+      ranges.emplace_back(block->getAddress(),
+                          block->getAddress() + block->getSize());
+  }
+  if (ranges.empty())
+    return std::make_error_condition(std::errc::invalid_argument);
+
+  const std::shared_ptr<PrettyPrinterFactory> factory = getFactory(module);
+  PrintingPolicy policy = getPolicy(*factory);
+  policy.skipFunctions.erase(name);
+  std::pmr::unsynchronized_pool_resource resource;
+  std::unique_ptr<PrettyPrinterBase> printer =
+      factory->create(prepared, policy, &resource);
+  PrettyPrinterBase::printAll({{printer.get(), &stream}}, std::move(ranges));
+
+  return std::error_condition{};
+}
+
+std::error_condition PrettyPrinter::printRange(std::ostream& stream,
+                                               const PreparedModule& prepared,
+                                               gtirb::Addr start,
+                                               gtirb::Addr end) const {
+  const std::shared_ptr<PrettyPrinterFactory> factory =
+      getFactory(prepared.getModule());
+  std::pmr::unsynchronized_pool_resource resource;
+  std::unique_ptr<PrettyPrinterBase> printer =
+      factory->create(prepared, getPolicy(*factory), &resource);
+  PrettyPrinterBase::printAll({{printer.get(), &stream}},
+                              std::vector<AddrRange>{{start, end}});
+
+  return std::error_condition{};
+}
+
+CapstoneHandle::CapstoneHandle(cs_opt_value syntax_)
+    : syntax(syntax_), handle(CapstonePool::instance().acquire(syntax)) {}
+
+CapstoneHandle::CapstoneHandle(CapstoneHandle&& other) noexcept
+    : syntax(other.syntax), handle(std::exchange(other.handle, 0)) {}
+
+CapstoneHandle& CapstoneHandle::operator=(CapstoneHandle&& other) noexcept {
+  CapstoneHandle moved(std::move(other));
+  std::swap(syntax, moved.syntax);
+  std::swap(handle, moved.handle);
+  return *this;
+}
+
+CapstoneHandle::~CapstoneHandle() {
+  if (handle)
+    CapstonePool::instance().release(syntax, handle);
+}
+
+DecodedInstructions::DecodedInstructions(DecodedInstructions&& other) noexcept
+    : insn(other.insn), count(other.count), owned(other.owned),
+      copies(std::move(other.copies)), details(std::move(other.details)) {
+  other.insn = nullptr;
+  other.count = 0;
+  other.owned = false;
+}
+
+DecodedInstructions&
+DecodedInstructions::operator=(DecodedInstructions&& other) noexcept {
+  DecodedInstructions moved(std::move(other));
+  std::swap(insn, moved.insn);
+  std::swap(count, moved.count);
+  std::swap(owned, moved.owned);
+  std::swap(copies, moved.copies);
+  std::swap(details, moved.details);
+  return *this;
+}
+
+DecodedInstructions::~DecodedInstructions() {
+  if (owned)
+    cs_free(insn, count);
+}
+
+DecodedInstructions DecodedInstructions::decode(csh handle,
+                                                const gtirb::Module& module,
+                                                const gtirb::Block& block) {
+  gtirb::ImageByteMap::const_range bytes =
+      getBytes(module.getImageByteMap(), block);
+  cs_insn* insn;
+  size_t count =
+      cs_disasm(handle, reinterpret_cast<const uint8_t*>(&bytes[0]),
+                bytes.size(), static_cast<uint64_t>(block.getAddress()), 0,
+                &insn);
+  return DecodedInstructions(insn, count);
+}
+
+DecodedInstructions
+DecodedInstructions::borrow(const DecodedInstructions& other) {
+  DecodedInstructions borrowed;
+  borrowed.insn = other.insn;
+  borrowed.count = other.count;
+  return borrowed;
+}
+
+DecodedInstructions
+DecodedInstructions::copy(const DecodedInstructions& other) {
+  DecodedInstructions copied;
+  copied.copies.assign(other.insn, other.insn + other.count);
+  copied.details.resize(other.count);
+  for (size_t i = 0; i < other.count; ++i) {
+    if (other.insn[i].detail) {
+      copied.details[i] = *other.insn[i].detail;
+      copied.copies[i].detail = &copied.details[i];
+    }
+  }
+  copied.insn = copied.copies.data();
+  copied.count = other.count;
+  return copied;
+}
+
+cs_insn& DecodedInstructions::modify(size_t i) {
+  assert(insn == copies.data() && "instructions are not a copy");
+  return copies[i];
+}
+
+/// Disassembles each block once, with detail and in Capstone's default
+/// (Intel) syntax, for all the printers of a multi-syntax print.
+class SharedDecoder {
+public:
+  explicit SharedDecoder(const gtirb::Module& module_) : module(module_) {}
+
+  /// Return the instructions of a block. The printers print the same block
+  /// one after the other, so only the last decoded block is kept.
+  const DecodedInstructions& decode(const gtirb::Block& block) {
+    if (&block != current) {
+      instructions = DecodedInstructions::decode(csHandle, module, block);
+      current = &block;
     }
+    return instructions;
+  }
+
+private:
+  const gtirb::Module& module;
+  CapstoneHandle csHandle;
+  const gtirb::Block* current = nullptr;
+  DecodedInstructions instructions;
+};
+
+/// The operations printed for instructions that can be printed from their
+/// bytes alone, keyed by those bytes.
+class OperationCache {
+public:
+  explicit OperationCache(std::pmr::memory_resource* resource)
+      : entries(resource) {}
+
+  const std::pmr::string* find(const cs_insn& inst) const {
+    auto found = entries.find(key(inst));
+    return found != entries.end() ? &found->second : nullptr;
+  }
+
+  void insert(const cs_insn& inst, std::pmr::string text) {
+    if (entries.size() < MaxEntries)
+      entries.emplace(key(inst), std::move(text));
+  }
+
+  /// Whether the operation of an instruction, decoded with or without
+  /// details, only depends on its bytes: no symbolic expression starts in
+  /// its bytes, and it is not a relative branch, whose target Capstone
+  /// prints as an absolute address.
+  static bool isCacheable(const gtirb::Module& module, const cs_insn& inst) {
+    if (isRelativeBranch(inst))
+      return false;
+    // The first byte is an opcode or a prefix, never part of an operand.
+    gtirb::Addr ea(inst.address);
+    for (uint16_t i = 1; i < inst.size; ++i)
+      if (module.findSymbolicExpression(ea + i) != module.symbolic_expr_end())
+        return false;
+    return true;
   }
 
-  if (const auto* functionBlocks =
-          module.getAuxData<std::map<gtirb::UUID, std::set<gtirb::UUID>>>(
-              "functionBlocks")) {
-    for (auto const& function : *functionBlocks) {
-      assert(function.second.size() > 0);
-      gtirb::Addr lastAddr{0};
-      for (auto& blockUUID : function.second) {
-        const auto* block = nodeFromUUID<gtirb::Block>(context, blockUUID);
-        assert(block && "UUID references non-existent block.");
-        if (block && block->getAddress() > lastAddr)
-          lastAddr = block->getAddress();
+private:
+  // x86 instructions are at most 15 bytes long, the last byte holds the size.
+  using Key = std::array<uint8_t, 16>;
+
+  struct KeyHash {
+    size_t operator()(const Key& k) const {
+      uint64_t hash = 0xcbf29ce484222325;
+      for (uint8_t byte : k)
+        hash = (hash ^ byte) * 0x100000001b3;
+      return static_cast<size_t>(hash);
+    }
+  };
+
+  static constexpr size_t MaxEntries = 1 << 16;
+
+  static Key key(const cs_insn& inst) {
+    Key k{};
+    std::copy_n(inst.bytes, std::min<size_t>(inst.size, k.size() - 1),
+                k.begin());
+    k.back() = static_cast<uint8_t>(inst.size);
+    return k;
+  }
+
+  static bool isRelativeBranch(const cs_insn& inst) {
+    switch (inst.id) {
+    case X86_INS_CALL:
+    case X86_INS_JMP:
+      // Relative after the prefixes, unless the opcode is 0xff (indirect).
+      for (uint16_t i = 0; i < inst.size; ++i) {
+        uint8_t byte = inst.bytes[i];
+        bool prefix = byte == 0x26 || byte == 0x2e || byte == 0x36 ||
+                      byte == 0x3e || byte == 0x64 || byte == 0x65 ||
+                      byte == 0x66 || byte == 0x67 || byte == 0xf0 ||
+                      byte == 0xf2 || byte == 0xf3 || (byte & 0xf0) == 0x40;
+        if (!prefix)
+          return byte != 0xff;
       }
-      functionLastBlock.insert(lastAddr);
+      return true;
+    case X86_INS_JAE:
+    case X86_INS_JA:
+    case X86_INS_JBE:
+    case X86_INS_JB:
+    case X86_INS_JCXZ:
+    case X86_INS_JECXZ:
+    case X86_INS_JE:
+    case X86_INS_JGE:
+    case X86_INS_JG:
+    case X86_INS_JLE:
+    case X86_INS_JL:
+    case X86_INS_JNE:
+    case X86_INS_JNO:
+    case X86_INS_JNP:
+    case X86_INS_JNS:
+    case X86_INS_JO:
+    case X86_INS_JP:
+    case X86_INS_JRCXZ:
+    case X86_INS_JS:
+    case X86_INS_LOOP:
+    case X86_INS_LOOPE:
+    case X86_INS_LOOPNE:
+    case X86_INS_XBEGIN:
+      return true;
+    default:
+      return false;
     }
   }
-}
 
-PrettyPrinterBase::~PrettyPrinterBase() { cs_close(&this->csHandle); }
+  std::pmr::unordered_map<Key, std::pmr::string, KeyHash> entries;
+};
+
+PrettyPrinterBase::PrettyPrinterBase(const PreparedModule& prepared_,
+                                     const Syntax& syntax_,
+                                     const PrintingPolicy& policy_,
+                                     std::pmr::memory_resource* resource_)
+    : syntax(syntax_), policy(policy_),
+      debug(policy.debug == DebugMessages ? true : false),
+      compact(policy.layout == CompactLayout), prepared(prepared_),
+      resource(resource_), context(prepared_.getContext()),
+      module(prepared_.getModule()),
+      operationCache(std::make_unique<OperationCache>(resource_)),
+      registerNames(resource_) {}
+
+PrettyPrinterBase::~PrettyPrinterBase() = default;
 
 const gtirb::SymAddrConst* PrettyPrinterBase::getSymbolicImmediate(
     const gtirb::SymbolicExpression* symex) {
@@ -209,108 +745,243 @@ const gtirb::SymAddrConst* PrettyPrinterBase::getSymbolicImmediate(
 }
 
 std::ostream& PrettyPrinterBase::print(std::ostream& os) {
-  printHeader(os);
-  // FIXME: simplify once block interation order is guaranteed by gtirb
-  auto address_order_block = [](const gtirb::Block* a, const gtirb::Block* b) {
-    return a->getAddress() < b->getAddress();
+  printAll({{this, &os}});
+  return os;
+}
+
+void PrettyPrinterBase::printAll(
+    const std::vector<std::pair<PrettyPrinterBase*, std::ostream*>>& printers,
+    std::optional<std::vector<AddrRange>> ranges) {
+  if (printers.empty())
+    return;
+  const PreparedModule& prepared = printers.front().first->prepared;
+  gtirb::Module& module = prepared.getModule();
+  assert(std::all_of(printers.begin(), printers.end(),
+                     [&](const auto& p) {
+                       return &p.first->prepared == &prepared;
+                     }) &&
+         "printers of different modules");
+
+  // A single printer decodes its own blocks.
+  std::optional<SharedDecoder> decoder;
+  if (printers.size() > 1)
+    decoder.emplace(module);
+
+  std::vector<gtirb::Addr> last(printers.size(), gtirb::Addr{0});
+  auto forEach = [&](auto print) {
+    for (size_t i = 0; i < printers.size(); ++i)
+      print(*printers[i].first, *printers[i].second, last[i]);
+  };
+
+  forEach([&](PrettyPrinterBase& pp, std::ostream& os, gtirb::Addr&) {
+    pp.sharedDecoder = decoder ? &*decoder : nullptr;
+    allocation_stats::Scope scope(allocation_stats::Phase::FileHeader);
+    pp.printHeader(os);
+  });
+
+  using BlockIt = std::pmr::vector<const gtirb::Block*>::const_iterator;
+  using DataIt = std::pmr::vector<const gtirb::DataObject*>::const_iterator;
+  auto printElements = [&](BlockIt blockIt, BlockIt blockEnd, DataIt dataIt,
+                           DataIt dataEnd) {
+    auto printNextBlock = [&](const gtirb::Block& block) {
+      forEach([&](PrettyPrinterBase& pp, std::ostream& os, gtirb::Addr& l) {
+        l = pp.printBlockOrWarning(os, block, l);
+      });
+    };
+    auto printNextDataObject = [&](const gtirb::DataObject& dataObject) {
+      forEach([&](PrettyPrinterBase& pp, std::ostream& os, gtirb::Addr& l) {
+        l = pp.printDataObjectOrWarning(os, dataObject, l);
+      });
+    };
+    // Jump over the rest of a skipped region once its first element is
+    // printed, as long as every printer skips it.
+    auto skipRegion = [&](gtirb::Addr addr) {
+      std::optional<gtirb::Addr> end;
+      for (const auto& printer : printers) {
+        std::optional<gtirb::Addr> e =
+            printer.first->getSkippedRegionEnd(addr);
+        if (!e)
+          return;
+        end = end ? std::min(*end, *e) : *e;
+      }
+      gtirb::Addr skippedLast{0};
+      skippedLast = skipElements(blockIt, blockEnd, *end, skippedLast);
+      skippedLast = skipElements(dataIt, dataEnd, *end, skippedLast);
+      forEach([&](PrettyPrinterBase&, std::ostream&, gtirb::Addr& l) {
+        l = std::max(l, skippedLast);
+      });
+    };
+    while (blockIt != blockEnd || dataIt != dataEnd) {
+      gtirb::Addr addr;
+      if (dataIt == dataEnd ||
+          (blockIt != blockEnd &&
+           (*blockIt)->getAddress() <= (*dataIt)->getAddress())) {
+        addr = (*blockIt)->getAddress();
+        printNextBlock(**blockIt++);
+      } else {
+        addr = (*dataIt)->getAddress();
+        printNextDataObject(**dataIt++);
+      }
+      skipRegion(addr);
+    }
   };
-  std::vector<const gtirb::Block*> blocks;
-  for (const gtirb::Block& block : gtirb::blocks(module.getCFG())) {
-    blocks.push_back(&block);
+
+  const auto& blocks = prepared.getBlocks();
+  const auto& dataObjects = prepared.getDataObjects();
+  if (!ranges) {
+    printElements(blocks.begin(), blocks.end(), dataObjects.begin(),
+                  dataObjects.end());
+  } else {
+    // Merge the overlapping and adjacent ranges.
+    std::sort(ranges->begin(), ranges->end());
+    std::vector<AddrRange> merged;
+    for (const AddrRange& range : *ranges) {
+      if (range.first >= range.second)
+        continue;
+      if (!merged.empty() && range.first <= merged.back().second)
+        merged.back().second = std::max(merged.back().second, range.second);
+      else
+        merged.push_back(range);
+    }
+
+    auto byAddress = [](const auto* x, gtirb::Addr a) {
+      return x->getAddress() < a;
+    };
+    for (const auto& [start, end] : merged) {
+      BlockIt blockIt =
+          std::lower_bound(blocks.begin(), blocks.end(), start, byAddress);
+      BlockIt blockEnd =
+          std::lower_bound(blockIt, blocks.end(), end, byAddress);
+      DataIt dataIt = std::lower_bound(dataObjects.begin(), dataObjects.end(),
+                                       start, byAddress);
+      DataIt dataEnd =
+          std::lower_bound(dataIt, dataObjects.end(), end, byAddress);
+      if (blockIt == blockEnd && dataIt == dataEnd)
+        continue;
+
+      // The range may start in the middle of a section.
+      gtirb::Addr first = blockIt != blockEnd ? (*blockIt)->getAddress()
+                                              : (*dataIt)->getAddress();
+      if (dataIt != dataEnd)
+        first = std::min(first, (*dataIt)->getAddress());
+      forEach([&](PrettyPrinterBase& pp, std::ostream&, gtirb::Addr&) {
+        pp.rangeStart = first;
+      });
+      printElements(blockIt, blockEnd, dataIt, dataEnd);
+    }
+  }
+
+  forEach([&](PrettyPrinterBase& pp, std::ostream& os, gtirb::Addr& l) {
+    pp.printModuleEnd(os, l);
+    pp.sharedDecoder = nullptr;
+  });
+}
+
+gtirb::Addr PrettyPrinterBase::printPart(std::ostream& os, gtirb::Addr last,
+                                         bool first, bool final) {
+  if (first) {
+    allocation_stats::Scope scope(allocation_stats::Phase::FileHeader);
+    printHeader(os);
   }
-  std::sort(blocks.begin(), blocks.end(), address_order_block);
+  // Same order as printAll.
+  const auto& blocks = prepared.getBlocks();
+  const auto& dataObjects = prepared.getDataObjects();
   auto blockIt = blocks.begin();
-  auto dataIt = module.data_begin();
-  gtirb::Addr last{0};
-  while (blockIt != blocks.end() && dataIt != module.data_end()) {
-    if ((*blockIt)->getAddress() <= dataIt->getAddress()) {
-      last = printBlockOrWarning(os, **blockIt, last);
-      blockIt++;
+  auto dataIt = dataObjects.begin();
+  while (blockIt != blocks.end() || dataIt != dataObjects.end()) {
+    gtirb::Addr addr;
+    if (dataIt == dataObjects.end() ||
+        (blockIt != blocks.end() &&
+         (*blockIt)->getAddress() <= (*dataIt)->getAddress())) {
+      addr = (*blockIt)->getAddress();
+      last = printBlockOrWarning(os, **blockIt++, last);
     } else {
-      last = printDataObjectOrWarning(os, *dataIt, last);
-      dataIt++;
+      addr = (*dataIt)->getAddress();
+      last = printDataObjectOrWarning(os, **dataIt++, last);
     }
+    if (std::optional<gtirb::Addr> end = getSkippedRegionEnd(addr)) {
+      last = skipElements(blockIt, blocks.end(), *end, last);
+      last = skipElements(dataIt, dataObjects.end(), *end, last);
+    }
+  }
+  if (final)
+    printModuleEnd(os, last);
+  return last;
+}
+
+bool PrettyPrinterBase::printElementPrologue(std::ostream& os,
+                                             gtirb::Addr nextAddr,
+                                             gtirb::Addr last) {
+  allocation_stats::Scope scope(allocation_stats::Phase::SectionHeader);
+  if (nextAddr < last) {
+    printOverlapWarning(os, nextAddr);
+    return false;
+  }
+  if (nextAddr > last) {
+    bool inData = !module.findData(last).empty();
+    printSymbolDefinitionsAtAddress(os, last, inData);
   }
-  for (; blockIt != blocks.end(); blockIt++)
-    last = printBlockOrWarning(os, **blockIt, last);
-  for (; dataIt != module.data_end(); dataIt++)
-    last = printDataObjectOrWarning(os, *dataIt, last);
+  printSectionFooter(os, nextAddr, last);
+  printSectionHeader(os, nextAddr);
+  rangeStart.reset();
+  return true;
+}
+
+void PrettyPrinterBase::printModuleEnd(std::ostream& os, gtirb::Addr last) {
+  allocation_stats::Scope scope(allocation_stats::Phase::FileHeader);
   bool inData = !module.findData(last).empty();
   printSymbolDefinitionsAtAddress(os, last, inData);
   printSectionFooter(os, std::nullopt, last);
   printFooter(os);
-  return os;
 }
 
 gtirb::Addr PrettyPrinterBase::printBlockOrWarning(std::ostream& os,
                                                    const gtirb::Block& block,
                                                    gtirb::Addr last) {
-  gtirb::Addr nextAddr = block.getAddress();
-  if (nextAddr < last) {
-    printOverlapWarning(os, nextAddr);
+  if (!printElementPrologue(os, block.getAddress(), last))
     return last;
-  } else {
-    if (nextAddr > last) {
-      bool inData = !module.findData(last).empty();
-      printSymbolDefinitionsAtAddress(os, last, inData);
-    }
-    printSectionFooter(os, nextAddr, last);
-    printSectionHeader(os, nextAddr);
-    printBlock(os, block);
-    return block.getAddress() + block.getSize();
-  }
+  printBlock(os, block);
+  return block.getAddress() + block.getSize();
 }
 
 gtirb::Addr PrettyPrinterBase::printDataObjectOrWarning(
     std::ostream& os, const gtirb::DataObject& dataObject, gtirb::Addr last) {
-  gtirb::Addr nextAddr = dataObject.getAddress();
-  if (nextAddr < last) {
-    printOverlapWarning(os, nextAddr);
+  if (!printElementPrologue(os, dataObject.getAddress(), last))
     return last;
-  } else {
-    if (nextAddr > last) {
-      bool inData = !module.findData(last).empty();
-      printSymbolDefinitionsAtAddress(os, last, inData);
-    }
-    printSectionFooter(os, nextAddr, last);
-    printSectionHeader(os, nextAddr);
-    printDataObject(os, dataObject);
-    return dataObject.getAddress() + dataObject.getSize();
-  }
+  printDataObject(os, dataObject);
+  return dataObject.getAddress() + dataObject.getSize();
 }
 
 void PrettyPrinterBase::printOverlapWarning(std::ostream& os,
                                             const gtirb::Addr addr) {
-  std::ios_base::fmtflags flags = os.flags();
-  os << syntax.comment() << " WARNING: found overlapping element at address "
-     << std::hex << static_cast<uint64_t>(addr) << ": ";
-  os.flags(flags);
+  os << syntax.comment() << " WARNING: found overlapping element at address ";
+  number_format::writeHex(os, static_cast<uint64_t>(addr));
+  os << ": ";
 }
 
 void PrettyPrinterBase::printBlock(std::ostream& os, const gtirb::Block& x) {
+  allocation_stats::Scope scope(allocation_stats::Phase::Block);
   if (skipEA(x.getAddress())) {
     return;
   }
   printFunctionHeader(os, x.getAddress());
-  os << '\n';
-
-  cs_insn* insn;
-  cs_option(this->csHandle, CS_OPT_DETAIL, CS_OPT_ON);
+  printBlockContents(os, x);
+}
 
-  gtirb::ImageByteMap::const_range bytes2 =
-      getBytes(module.getImageByteMap(), x);
-  size_t count =
-      cs_disasm(this->csHandle, reinterpret_cast<const uint8_t*>(&bytes2[0]),
-                bytes2.size(), static_cast<uint64_t>(x.getAddress()), 0, &insn);
+void PrettyPrinterBase::printBlockContents(std::ostream& os,
+                                           const gtirb::Block& x) {
+  if (!compact)
+    os << '\n';
 
-  // Exception-safe cleanup of instructions
-  std::unique_ptr<cs_insn, std::function<void(cs_insn*)>> freeInsn(
-      insn, [count](cs_insn* i) { cs_free(i, count); });
+  DecodedInstructions insns =
+      sharedDecoder ? adaptInstructions(x, sharedDecoder->decode(x))
+                    : decodeBlock(x);
 
   gtirb::Offset offset(x.getUUID(), 0);
-  for (size_t i = 0; i < count; i++) {
-    printInstruction(os, insn[i], offset);
-    offset.Displacement += insn[i].size;
+  for (size_t i = 0; i < insns.size(); i++) {
+    allocation_stats::Scope scope(allocation_stats::Phase::Instruction);
+    printInstruction(os, insns[i], offset);
+    offset.Displacement += insns[i].size;
     os << '\n';
   }
   // print any CFI directives located at the end of the block
@@ -319,17 +990,34 @@ void PrettyPrinterBase::printBlock(std::ostream& os, const gtirb::Block& x) {
   printFunctionFooter(os, x.getAddress());
 }
 
+DecodedInstructions PrettyPrinterBase::decodeBlock(const gtirb::Block& x) {
+  cs_option(this->csHandle, CS_OPT_DETAIL, CS_OPT_OFF);
+  DecodedInstructions insns =
+      DecodedInstructions::decode(this->csHandle, module, x);
+  cs_option(this->csHandle, CS_OPT_DETAIL, CS_OPT_ON);
+  return insns;
+}
+
+DecodedInstructions
+PrettyPrinterBase::adaptInstructions(const gtirb::Block& x,
+                                     const DecodedInstructions& shared) {
+  if (this->csHandle.getSyntax() == CS_OPT_SYNTAX_DEFAULT)
+    return DecodedInstructions::borrow(shared);
+  return decodeBlock(x);
+}
+
 void PrettyPrinterBase::printSectionHeader(std::ostream& os,
                                            const gtirb::Addr addr) {
   const auto found_section = module.findSection(addr);
   if (found_section.begin() == found_section.end())
     return;
-  if (found_section.begin()->getAddress() != addr)
+  if (found_section.begin()->getAddress() != addr && rangeStart != addr)
     return;
   std::string sectionName = found_section.begin()->getName();
   if (policy.skipSections.count(sectionName))
     return;
-  os << '\n';
+  if (!compact)
+    os << '\n';
   printBar(os);
   if (sectionName == syntax.textSection()) {
     os << syntax.text() << '\n';
@@ -340,14 +1028,15 @@ void PrettyPrinterBase::printSectionHeader(std::ostream& os,
   } else {
     printSectionHeaderDirective(os, *(found_section.begin()));
     printSectionProperties(os, *(found_section.begin()));
-    os << std::endl;
+    os << '\n';
   }
   if (policy.arraySections.count(sectionName))
     os << syntax.align() << " 8\n";
   else
     printAlignment(os, addr);
   printBar(os);
-  os << '\n';
+  if (!compact)
+    os << '\n';
 }
 
 void PrettyPrinterBase::printSectionFooter(
@@ -379,6 +1068,8 @@ void PrettyPrinterBase::printSectionFooter(
 }
 
 void PrettyPrinterBase::printBar(std::ostream& os, bool heavy) {
+  if (compact)
+    return;
   if (heavy) {
     os << syntax.comment() << "===================================\n";
   } else {
@@ -389,10 +1080,9 @@ void PrettyPrinterBase::printBar(std::ostream& os, bool heavy) {
 void PrettyPrinterBase::printSymbolReference(std::ostream& os,
                                              const gtirb::Symbol* symbol,
                                              bool inData) const {
-  std::optional<std::string> forwardedName =
-      getForwardedSymbolName(symbol, inData);
-  if (forwardedName) {
-    os << forwardedName.value();
+  allocation_stats::Scope scope(allocation_stats::Phase::SymbolReference);
+  if (const gtirb::Symbol* forwarded = getForwardedSymbol(symbol)) {
+    os << forwarded->getName() << getForwardedSymbolEnding(symbol, inData);
     return;
   }
   if (symbol->getAddress() && skipEA(*symbol->getAddress())) {
@@ -402,7 +1092,7 @@ void PrettyPrinterBase::printSymbolReference(std::ostream& os,
   if (this->isAmbiguousSymbol(symbol->getName()))
     os << getSymbolName(*symbol->getAddress());
   else
-    os << syntax.formatSymbolName(symbol->getName());
+    syntax.writeSymbolName(os, symbol->getName());
 }
 
 void PrettyPrinterBase::printSymbolDefinitionsAtAddress(std::ostream& os,
@@ -429,6 +1119,11 @@ void PrettyPrinterBase::printInstruction(std::ostream& os, const cs_insn& inst,
   // special cases
 
   if (inst.id == X86_INS_NOP) {
+    if (compact && inst.size > 1) {
+      // The same bytes as one single-byte NOP per byte.
+      os << "  " << syntax.fill() << ' ' << inst.size << ", 1, 0x90";
+      return;
+    }
     os << "  " << syntax.nop();
     for (uint64_t i = 1; i < inst.size; ++i) {
       ea += 1;
@@ -442,81 +1137,134 @@ void PrettyPrinterBase::printInstruction(std::ostream& os, const cs_insn& inst,
   // end special cases
   ////////////////////////////////////////////////////////////////////
 
-  std::string opcode = ascii_str_tolower(inst.mnemonic);
-  os << "  " << opcode << ' ';
+  if (inst.detail)
+    printOperation(os, inst);
+  else
+    printOperationWithoutDetail(os, inst);
+}
+
+void PrettyPrinterBase::printOperation(std::ostream& os, const cs_insn& inst) {
+  printMnemonic(os, inst);
   printOperandList(os, inst);
 }
 
+void PrettyPrinterBase::printMnemonic(std::ostream& os, const cs_insn& inst) {
+  os << "  ";
+  write_ascii_lower(os, inst.mnemonic);
+  os << ' ';
+}
+
+void PrettyPrinterBase::printOperationWithoutDetail(std::ostream& os,
+                                                    const cs_insn& inst) {
+  // Only the instructions that are neither cached nor cacheable, or whose
+  // operation is not cached yet, are decoded again, with details.
+  bool cacheable = OperationCache::isCacheable(module, inst);
+  if (cacheable) {
+    if (const std::pmr::string* text = operationCache->find(inst)) {
+      os << *text;
+      return;
+    }
+  }
+
+  cs_insn* detailed;
+  [[maybe_unused]] size_t count = cs_disasm(
+      this->csHandle, inst.bytes, inst.size, inst.address, 1, &detailed);
+  assert(count == 1 && "instruction cannot be decoded again");
+  if (cacheable) {
+    std::pmr::string entry(resource);
+    StringAppendBuffer buffer(entry);
+    std::ostream text(&buffer);
+    printOperation(text, *detailed);
+    os << entry;
+    operationCache->insert(inst, std::move(entry));
+  } else {
+    printOperation(os, *detailed);
+  }
+  cs_free(detailed, 1);
+}
+
+const std::string& PrettyPrinterBase::indent() const {
+  static const std::string None;
+  return compact ? None : syntax.tab();
+}
+
 void PrettyPrinterBase::printEA(std::ostream& os, gtirb::Addr ea) {
-  os << syntax.tab();
+  os << indent();
   if (this->debug) {
-    os << std::hex << static_cast<uint64_t>(ea) << ": " << std::dec;
+    number_format::writeHex(os, static_cast<uint64_t>(ea));
+    os << ": ";
   }
 }
 
 void PrettyPrinterBase::printOperandList(std::ostream& os,
                                          const cs_insn& inst) {
-  cs_x86& detail = inst.detail->x86;
-  uint8_t opCount = detail.op_count;
+  printOperandsWith(os, inst,
+                    [this](std::ostream& os_, const cs_insn& inst_,
+                           uint64_t index) {
+                      printOperand(os_, inst_, index);
+                    });
+}
 
+uint8_t PrettyPrinterBase::getPrintedOperandCount(const cs_insn& inst) {
   // Operands are implicit for various MOVS* instructions. But there is also
   // an SSE2 instruction named MOVSD which has explicit operands.
   if ((inst.id == X86_INS_MOVSB || inst.id == X86_INS_MOVSW ||
        inst.id == X86_INS_MOVSD || inst.id == X86_INS_MOVSQ) &&
       inst.detail->groups[0] != X86_GRP_SSE2) {
-    opCount = 0;
+    return 0;
   }
 
   // Register operands are implicit for STOS* instructions.
   if (inst.id == X86_INS_STOSB || inst.id == X86_INS_STOSW ||
       inst.id == X86_INS_STOSD || inst.id == X86_INS_STOSQ) {
-    opCount = 1;
+    return 1;
   }
+  return inst.detail->x86.op_count;
+}
 
-  for (int i = 0; i < opCount; i++) {
-    if (i != 0) {
-      os << ',';
-    }
-    printOperand(os, inst, i);
-  }
+const gtirb::SymbolicExpression*
+PrettyPrinterBase::getSymbolicOperand(const cs_insn& inst,
+                                      const cs_x86_op& op) const {
+  gtirb::Addr ea(inst.address);
+  uint8_t fieldOffset = 0;
+  if (op.type == X86_OP_IMM)
+    fieldOffset = inst.detail->x86.encoding.imm_offset;
+  else if (op.type == X86_OP_MEM)
+    fieldOffset = inst.detail->x86.encoding.disp_offset;
+  // A memory operand without displacement has no field to be symbolic.
+  if (fieldOffset == 0 && op.type != X86_OP_IMM)
+    return nullptr;
+  auto found = module.findSymbolicExpression(ea + fieldOffset);
+  if (found == module.symbolic_expr_end())
+    return nullptr;
+  return &*found;
 }
 
 void PrettyPrinterBase::printOperand(std::ostream& os, const cs_insn& inst,
                                      uint64_t index) {
-  gtirb::Addr ea(inst.address);
-  const cs_x86_op& op = inst.detail->x86.operands[index];
-
-  const gtirb::SymbolicExpression* symbolic = nullptr;
-  uint8_t immOffset = inst.detail->x86.encoding.imm_offset;
-  uint8_t dispOffset = inst.detail->x86.encoding.disp_offset;
+  printOperandWith(
+      os, inst, index,
+      [this](std::ostream& os_, const cs_insn& inst_, const cs_x86_op& op) {
+        printOpRegdirect(os_, inst_, op);
+      },
+      [this](std::ostream& os_, const gtirb::SymbolicExpression* symbolic,
+             const cs_insn& inst_, uint64_t index_) {
+        printOpImmediate(os_, symbolic, inst_, index_);
+      },
+      [this](std::ostream& os_, const gtirb::SymbolicExpression* symbolic,
+             const cs_insn& inst_, uint64_t index_) {
+        printOpIndirect(os_, symbolic, inst_, index_);
+      });
+}
 
-  switch (op.type) {
-  case X86_OP_REG:
-    printOpRegdirect(os, inst, op);
-    return;
-  case X86_OP_IMM: {
-    auto found = module.findSymbolicExpression(ea + immOffset);
-    if (found != module.symbolic_expr_end())
-      symbolic = &*found;
-  }
-    printOpImmediate(os, symbolic, inst, index);
-    return;
-  case X86_OP_MEM:
-    if (dispOffset > 0) {
-      auto found = module.findSymbolicExpression(ea + dispOffset);
-      if (found != module.symbolic_expr_end())
-        symbolic = &*found;
-    }
-    printOpIndirect(os, symbolic, inst, index);
-    return;
-  case X86_OP_INVALID:
-    std::cerr << "invalid operand\n";
-    exit(1);
-  }
+void PrettyPrinterBase::invalidOperand() {
+  std::cerr << "invalid operand\n";
+  exit(1);
 }
 
 void PrettyPrinterBase::printDataObject(std::ostream& os,
                                         const gtirb::DataObject& dataObject) {
+  allocation_stats::Scope scope(allocation_stats::Phase::DataObject);
   gtirb::Addr addr = dataObject.getAddress();
   if (skipEA(addr)) {
     return;
@@ -524,8 +1272,10 @@ void PrettyPrinterBase::printDataObject(std::ostream& os,
   printComments(os, gtirb::Offset(dataObject.getUUID(), 0),
                 dataObject.getSize());
   printSymbolDefinitionsAtAddress(os, addr, true);
-  if (this->debug)
-    os << std::hex << static_cast<uint64_t>(addr) << std::dec << ':';
+  if (this->debug) {
+    number_format::writeHex(os, static_cast<uint64_t>(addr));
+    os << ':';
+  }
   const auto section = getContainerSection(addr);
   assert(section && "Found a data object outside all sections");
   if (shouldExcludeDataElement(**section, dataObject))
@@ -542,31 +1292,30 @@ void PrettyPrinterBase::printNonZeroDataObject(
   const auto& foundSymbolic =
       module.findSymbolicExpression(dataObject.getAddress());
   if (foundSymbolic != module.symbolic_expr_end()) {
-    os << syntax.tab();
+    os << indent();
     printSymbolicData(os, &*foundSymbolic, dataObject);
     os << '\n';
     return;
   }
-  const auto* types =
-      module.getAuxData<std::map<gtirb::UUID, std::string>>("encodings");
+  const auto* types = prepared.getEncodings();
   if (types) {
     auto foundType = types->find(dataObject.getUUID());
     if (foundType != types->end() && foundType->second == "string") {
-      os << syntax.tab();
+      os << indent();
       printString(os, dataObject);
       os << '\n';
       return;
     }
   }
   for (std::byte byte : getBytes(module.getImageByteMap(), dataObject)) {
-    os << syntax.tab();
+    os << indent();
     printByte(os, byte);
   }
 }
 
 void PrettyPrinterBase::printZeroDataObject(
     std::ostream& os, const gtirb::DataObject& dataObject) {
-  os << syntax.tab();
+  os << indent();
   os << " .zero " << dataObject.getSize() << '\n';
 }
 
@@ -576,8 +1325,7 @@ void PrettyPrinterBase::printComments(std::ostream& os,
   if (!this->debug)
     return;
 
-  if (const auto* comments =
-          module.getAuxData<std::map<gtirb::Offset, std::string>>("comments")) {
+  if (const auto* comments = prepared.getComments()) {
     gtirb::Offset endOffset(offset.ElementId, offset.Displacement + range);
     for (auto p = comments->lower_bound(offset);
          p != comments->end() && p->first < endOffset; ++p) {
@@ -591,10 +1339,7 @@ void PrettyPrinterBase::printComments(std::ostream& os,
 
 void PrettyPrinterBase::printCFIDirectives(std::ostream& os,
                                            const gtirb::Offset& offset) {
-  const auto* cfiDirectives = module.getAuxData<std::map<
-      gtirb::Offset,
-      std::vector<std::tuple<std::string, std::vector<int64_t>, gtirb::UUID>>>>(
-      "cfiDirectives");
+  const auto* cfiDirectives = prepared.getCFIDirectives();
   if (!cfiDirectives)
     return;
   const auto entry = cfiDirectives->find(offset);
@@ -618,7 +1363,7 @@ void PrettyPrinterBase::printCFIDirectives(std::ostream& os,
       printSymbolReference(os, symbol, true);
     }
 
-    os << std::endl;
+    os << '\n';
   }
 }
 
@@ -636,8 +1381,7 @@ void PrettyPrinterBase::printSymbolicData(
 
 void PrettyPrinterBase::printDataObjectType(
     std::ostream& os, const gtirb::DataObject& dataObject) {
-  const auto* types =
-      module.getAuxData<std::map<gtirb::UUID, std::string>>("encodings");
+  const auto* types = prepared.getEncodings();
   if (types) {
     auto foundType = types->find(dataObject.getUUID());
     if (foundType != types->end()) {
@@ -714,7 +1458,65 @@ bool PrettyPrinterBase::shouldExcludeDataElement(
 }
 
 bool PrettyPrinterBase::skipEA(const gtirb::Addr x) const {
-  return !this->debug && (isInSkippedSection(x) || isInSkippedFunction(x));
+  return !this->debug && getSkippedRegionEnd(x).has_value();
+}
+
+std::optional<gtirb::Addr>
+PrettyPrinterBase::getSkippedRegionEnd(gtirb::Addr addr) const {
+  if (debug)
+    return std::nullopt;
+  const std::vector<AddrRange>& ranges = *getSkippedRanges();
+  auto it = std::upper_bound(
+      ranges.begin(), ranges.end(), addr,
+      [](gtirb::Addr a, const AddrRange& range) { return a < range.first; });
+  if (it == ranges.begin() || std::prev(it)->second <= addr)
+    return std::nullopt;
+  gtirb::Addr end = std::prev(it)->second;
+  // Stop at the end of the section, whose successor may have a header.
+  if (const auto section = getContainerSection(addr))
+    end = std::min(end, (*section)->getAddress() + (*section)->getSize());
+  return end;
+}
+
+std::shared_ptr<const std::vector<AddrRange>>
+PrettyPrinterBase::getSkippedRanges() const {
+  if (skippedRanges)
+    return skippedRanges;
+  std::vector<AddrRange> ranges;
+  for (const gtirb::Section& section : module.sections())
+    if (policy.skipSections.count(section.getName()))
+      ranges.emplace_back(section.getAddress(),
+                          section.getAddress() + section.getSize());
+  // Like getContainerFunctionName, a function extends to the next entry, and
+  // the last one to the end of the module.
+  if (!policy.skipFunctions.empty()) {
+    const std::pmr::vector<gtirb::Addr>& entries =
+        prepared.getModuleFunctionEntries();
+    const gtirb::Addr moduleEnd{std::numeric_limits<uint64_t>::max()};
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+      if (!policy.skipFunctions.count(getFunctionName(*it)))
+        continue;
+      auto next = std::next(it);
+      ranges.emplace_back(*it, next != entries.end() ? *next : moduleEnd);
+    }
+  }
+  std::sort(ranges.begin(), ranges.end());
+  auto merged = std::make_shared<std::vector<AddrRange>>();
+  for (const AddrRange& range : ranges) {
+    if (range.first >= range.second)
+      continue;
+    if (!merged->empty() && range.first <= merged->back().second)
+      merged->back().second = std::max(merged->back().second, range.second);
+    else
+      merged->push_back(range);
+  }
+  skippedRanges = std::move(merged);
+  return skippedRanges;
+}
+
+void PrettyPrinterBase::setSkippedRanges(
+    std::shared_ptr<const std::vector<AddrRange>> ranges) {
+  skippedRanges = std::move(ranges);
 }
 
 bool PrettyPrinterBase::isInSkippedSection(const gtirb::Addr addr) const {
@@ -732,17 +1534,21 @@ bool PrettyPrinterBase::isInSkippedFunction(const gtirb::Addr x) const {
 }
 
 bool PrettyPrinterBase::isFunctionEntry(const gtirb::Addr x) const {
-  return functionEntry.count(x) > 0;
+  const std::pmr::vector<gtirb::Addr>& entries =
+      prepared.getModuleFunctionEntries();
+  return std::binary_search(entries.begin(), entries.end(), x);
 }
 
 bool PrettyPrinterBase::isFunctionLastBlock(const gtirb::Addr x) const {
-  return functionLastBlock.count(x) > 0;
+  return prepared.getFunctionLastBlocks().count(x) > 0;
 }
 
 std::optional<std::string>
 PrettyPrinterBase::getContainerFunctionName(const gtirb::Addr x) const {
-  auto it = functionEntry.upper_bound(x);
-  if (it == functionEntry.begin())
+  const std::pmr::vector<gtirb::Addr>& entries =
+      prepared.getModuleFunctionEntries();
+  auto it = std::upper_bound(entries.begin(), entries.end(), x);
+  if (it == entries.begin())
     return std::nullopt;
   it--;
   return this->getFunctionName(*it);
@@ -762,15 +1568,28 @@ std::string PrettyPrinterBase::getRegisterName(unsigned int reg) const {
       reg == X86_REG_INVALID ? "" : cs_reg_name(this->csHandle, reg));
 }
 
+std::string_view PrettyPrinterBase::registerName(unsigned int reg) {
+  if (registerNames.empty()) {
+    registerNames.reserve(X86_REG_ENDING);
+    for (unsigned int r = 0; r < X86_REG_ENDING; ++r) {
+      std::string name = getRegisterName(r);
+      registerNames.emplace_back(name.data(), name.size());
+    }
+  }
+  return reg < registerNames.size() ? std::string_view(registerNames[reg])
+                                    : std::string_view();
+}
+
 void PrettyPrinterBase::printAddend(std::ostream& os, int64_t number,
                                     bool first) {
   if (number < 0 || first) {
-    os << number;
+    number_format::writeDecimal(os, number);
     return;
   }
   if (number == 0)
     return;
-  os << "+" << number;
+  os << '+';
+  number_format::writeDecimal(os, number);
 }
 
 void PrettyPrinterBase::printAlignment(std::ostream& os, gtirb::Addr addr) {
@@ -802,47 +1621,43 @@ std::string PrettyPrinterBase::getFunctionName(gtirb::Addr x) const {
     const auto symbols = module.findSymbols(x);
     if (!symbols.empty()) {
       const gtirb::Symbol& s = symbols.front();
-      std::stringstream name(s.getName());
-      if (isAmbiguousSymbol(s.getName())) {
-        name.seekp(0, std::ios_base::end);
-        name << '_' << std::hex << static_cast<uint64_t>(x);
-      }
-      return name.str();
+      if (isAmbiguousSymbol(s.getName()))
+        return s.getName() + '_' + toHex(x);
+      return s.getName();
     }
   }
 
   // Is this a function entry with no associated symbol?
-  if (entry_point) {
-    std::stringstream name;
-    name << "unknown_function_" << std::hex << static_cast<uint64_t>(x);
-    return name.str();
-  }
+  if (entry_point)
+    return "unknown_function_" + toHex(x);
 
   // This doesn't seem to be a function.
   return std::string{};
 }
 
 std::string PrettyPrinterBase::getSymbolName(gtirb::Addr x) const {
-  std::stringstream ss;
-  ss << ".L_" << std::hex << uint64_t(x) << std::dec;
-  return ss.str();
+  return ".L_" + toHex(x);
 }
 
 std::optional<std::string>
 PrettyPrinterBase::getForwardedSymbolName(const gtirb::Symbol* symbol,
                                           bool inData) const {
-  const auto* symbolForwarding =
-      module.getAuxData<std::map<gtirb::UUID, gtirb::UUID>>("symbolForwarding");
+  if (const gtirb::Symbol* forwarded = getForwardedSymbol(symbol))
+    return forwarded->getName() + getForwardedSymbolEnding(symbol, inData);
+  return {};
+}
+
+const gtirb::Symbol*
+PrettyPrinterBase::getForwardedSymbol(const gtirb::Symbol* symbol) const {
+  const auto* symbolForwarding = prepared.getSymbolForwarding();
 
   if (symbolForwarding) {
     auto found = symbolForwarding->find(symbol->getUUID());
-    if (found != symbolForwarding->end()) {
-      gtirb::Node* destSymbol = gtirb::Node::getByUUID(context, found->second);
-      return (cast<gtirb::Symbol>(destSymbol))->getName() +
-             getForwardedSymbolEnding(symbol, inData);
-    }
+    if (found != symbolForwarding->end())
+      return cast<gtirb::Symbol>(
+          gtirb::Node::getByUUID(context, found->second));
   }
-  return {};
+  return nullptr;
 }
 
 std::string
@@ -853,7 +1668,7 @@ PrettyPrinterBase::getForwardedSymbolEnding(const gtirb::Symbol* symbol,
     const auto container_sections = module.findSection(addr);
     if (container_sections.begin() == container_sections.end())
       return std::string{};
-    std::string section_name = container_sections.begin()->getName();
+    const std::string& section_name = container_sections.begin()->getName();
     if (!inData && (section_name == ".plt" || section_name == ".plt.got"))
       return std::string{"@PLT"};
     if (section_name == ".got" || section_name == ".got.plt")
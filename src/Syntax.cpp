@@ -14,13 +14,13 @@
 //===----------------------------------------------------------------------===//
 #include "Syntax.hpp"
 
-#include <boost/range/algorithm/find_if.hpp>
-#include <map>
-#include <vector>
+#include <algorithm>
+#include <array>
+#include <ostream>
 
 namespace gtirb_pprint {
 
-std::optional<std::string> Syntax::getSizeName(uint64_t bits) const {
+std::optional<std::string_view> Syntax::getSizeName(uint64_t bits) const {
   switch (bits) {
   case 256:
     return "YMMWORD";
@@ -44,20 +44,30 @@ std::string Syntax::formatSectionName(const std::string& x) const { return x; }
 
 std::string Syntax::formatFunctionName(const std::string& x) const { return x; }
 
+namespace {
+// Whether a symbol name would be read as a register or an operator.
+bool conflictsWithRegName(std::string_view x) {
+  static constexpr std::array<std::string_view, 11> adapt{
+      "FS", "MOD", "DIV", "NOT", "mod", "div", "not", "and", "or", "shr", "Si"};
+  return std::find(std::begin(adapt), std::end(adapt), x) != std::end(adapt);
+}
+} // namespace
+
 std::string Syntax::formatSymbolName(const std::string& x) const {
   return avoidRegNameConflicts(x);
 }
 
 std::string Syntax::avoidRegNameConflicts(const std::string& x) const {
-  const std::vector<std::string> adapt{"FS",  "MOD", "DIV", "NOT", "mod", "div",
-                                       "not", "and", "or",  "shr", "Si"};
-
-  if (const auto found = std::find(std::begin(adapt), std::end(adapt), x);
-      found != std::end(adapt)) {
+  if (conflictsWithRegName(x))
     return x + "_renamed";
-  }
 
   return x;
 }
 
+void Syntax::writeSymbolName(std::ostream& os, const std::string& x) const {
+  os << x;
+  if (conflictsWithRegName(x))
+    os << "_renamed";
+}
+
 } // namespace gtirb_pprint
@@ -0,0 +1,161 @@
+//===- Trace.cpp ------------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2019 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+#include "Trace.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <vector>
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif // _WIN32
+
+namespace gtirb_pprint {
+namespace trace {
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+struct Event {
+  const char* category;
+  std::string name;
+  std::string detail;
+  int thread;
+  int64_t begin;
+  int64_t duration;
+};
+
+std::atomic<bool> active{false};
+std::mutex mutex;
+std::vector<Event> events;
+Clock::time_point origin;
+
+// Small thread numbers are easier to read in a trace viewer than the
+// operating system's.
+int threadNumber() {
+  static std::atomic<int> threads{0};
+  thread_local int number = ++threads;
+  return number;
+}
+
+int processId() {
+#ifdef _WIN32
+  return _getpid();
+#else
+  return static_cast<int>(getpid());
+#endif // _WIN32
+}
+
+int64_t microseconds(Clock::duration d) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+}
+
+void writeString(std::ostream& os, std::string_view s) {
+  os << '"';
+  for (char c : s) {
+    switch (c) {
+    case '"':
+      os << "\\\"";
+      break;
+    case '\\':
+      os << "\\\\";
+      break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20) {
+        char escaped[7];
+        std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+        os << escaped;
+      } else {
+        os << c;
+      }
+    }
+  }
+  os << '"';
+}
+} // namespace
+
+void start() {
+  std::lock_guard<std::mutex> lock(mutex);
+  events.clear();
+  origin = Clock::now();
+  active = true;
+}
+
+bool recording() { return active.load(std::memory_order_relaxed); }
+
+bool write(std::ostream& os) {
+  std::lock_guard<std::mutex> lock(mutex);
+  active = false;
+  int pid = processId();
+  os << "{\"traceEvents\":[";
+  for (size_t i = 0; i < events.size(); ++i) {
+    const Event& event = events[i];
+    os << (i == 0 ? "\n" : ",\n") << "{\"ph\":\"X\",\"cat\":";
+    writeString(os, event.category);
+    os << ",\"name\":";
+    writeString(os, event.name);
+    os << ",\"pid\":" << pid << ",\"tid\":" << event.thread
+       << ",\"ts\":" << event.begin << ",\"dur\":" << event.duration;
+    if (!event.detail.empty()) {
+      os << ",\"args\":{\"detail\":";
+      writeString(os, event.detail);
+      os << '}';
+    }
+    os << '}';
+  }
+  os << "\n],\"displayTimeUnit\":\"ms\"}\n";
+  events.clear();
+  return static_cast<bool>(os);
+}
+
+Span::Span(const char* category_, std::string_view name_,
+           std::string_view detail_)
+    : category(category_), active(recording()) {
+  if (!active)
+    return;
+  name = name_;
+  detail = detail_;
+  begin = Clock::now();
+}
+
+Span::~Span() {
+  if (!active)
+    return;
+  Clock::time_point end = Clock::now();
+  int thread = threadNumber();
+  std::lock_guard<std::mutex> lock(mutex);
+  // Spans still open when the recording stopped are dropped.
+  if (!recording())
+    return;
+  events.push_back(Event{category, std::move(name), std::move(detail), thread,
+                         microseconds(begin - origin),
+                         microseconds(end - begin)});
+}
+
+TraceFile::TraceFile(std::string path_) : path(std::move(path_)) { start(); }
+
+TraceFile::~TraceFile() {
+  std::ofstream ofs(path);
+  if (!ofs || !write(ofs))
+    std::cerr << "ERROR: Could not write the trace to " << path << "\n";
+}
+
+} // namespace trace
+} // namespace gtirb_pprint
@@ -0,0 +1,55 @@
+//===- file_utils.cpp -------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2019 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+#include "file_utils.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#ifndef _WIN32
+#include <unistd.h>
+#endif // _WIN32
+#ifdef USE_STD_FILESYSTEM_LIB
+#include <filesystem>
+namespace fs = std::filesystem;
+#else
+#include <experimental/filesystem>
+namespace fs = std::experimental::filesystem;
+#endif // USE_STD_FILESYSTEM_LIB
+
+namespace gtirb_bprint {
+
+TempFile::TempFile(const std::string& extension, std::ios_base::openmode mode) {
+#ifdef _WIN32
+  std::string tmpFileName;
+  std::FILE* f = nullptr;
+  while (!f) {
+    tmpFileName = std::tmpnam(nullptr);
+    tmpFileName += extension;
+    f = fopen(tmpFileName.c_str(), "wx");
+  }
+  fclose(f);
+#else
+  std::string tmpFileName = "/tmp/fileXXXXXX" + extension;
+  close(mkstemps(&tmpFileName[0], static_cast<int>(extension.size())));
+#endif // _WIN32
+  name = tmpFileName;
+  fileStream.open(name, mode);
+}
+
+TempFile::~TempFile() {
+  if (fs::exists(name))
+    fs::remove(name);
+}
+
+} // namespace gtirb_bprint
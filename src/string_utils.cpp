@@ -17,6 +17,7 @@
 
 #include <algorithm>
 #include <cctype>
+#include <ostream>
 
 std::string ascii_str_tolower(std::string s) {
   std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) {
@@ -31,3 +32,15 @@ std::string ascii_str_toupper(std::string s) {
   });
   return s;
 }
+
+void write_ascii_lower(std::ostream& os, std::string_view s) {
+  char buffer[64];
+  while (!s.empty()) {
+    size_t n = std::min(s.size(), sizeof(buffer));
+    std::transform(s.begin(), s.begin() + n, buffer, [](unsigned char c) {
+      return static_cast<char>(std::tolower(c));
+    });
+    os.write(buffer, static_cast<std::streamsize>(n));
+    s.remove_prefix(n);
+  }
+}
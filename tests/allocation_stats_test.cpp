@@ -0,0 +1,99 @@
+//===- allocation_stats_test.cpp --------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2019 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+//
+// Fails if printing allocates more per instruction than it used to. Requires
+// a library configured with GTIRB_PPRINTER_ALLOCATION_STATS=ON.
+//
+//===----------------------------------------------------------------------===//
+#include "AllocationStats.hpp"
+#include "PrettyPrinter.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+using gtirb_pprint::allocation_stats::Phase;
+
+// The allocations per instruction allowed in each phase. Instructions only
+// allocate when the pool of the printer grows, symbol references only for
+// ambiguous names, and blocks for their function headers and CFI
+// directives, so each phase stays well under one allocation per instruction. Lower them when printing gets
+// cheaper, never raise them without a good reason.
+struct Budget {
+  Phase phase;
+  double perInstruction;
+};
+
+constexpr Budget Budgets[] = {
+    {Phase::Instruction, 1.0},
+    {Phase::SymbolReference, 0.5},
+    {Phase::Block, 1.0},
+};
+
+// Discards everything written to it.
+class NullBuffer : public std::streambuf {
+protected:
+  int overflow(int c) override { return c; }
+  std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+  namespace stats = gtirb_pprint::allocation_stats;
+  if (argc != 2) {
+    std::cerr << "usage: " << argv[0] << " IR\n";
+    return EXIT_FAILURE;
+  }
+  if (!stats::enabled()) {
+    std::cerr << "allocations are not counted in this build\n";
+    return EXIT_FAILURE;
+  }
+  gtirb::Context ctx;
+  std::ifstream in(argv[1], std::ios::in | std::ios::binary);
+  gtirb::IR* ir = gtirb::IR::load(ctx, in);
+  if (!ir || ir->modules().empty()) {
+    std::cerr << "could not load " << argv[1] << '\n';
+    return EXIT_FAILURE;
+  }
+
+  NullBuffer buffer;
+  std::ostream os(&buffer);
+  stats::reset();
+  for (gtirb::Module& module : ir->modules())
+    gtirb_pprint::PrettyPrinter().print(os, ctx, module);
+  stats::report(std::cout);
+
+  uint64_t instructions = stats::get(Phase::Instruction).elements;
+  if (instructions == 0) {
+    std::cerr << "no instruction printed\n";
+    return EXIT_FAILURE;
+  }
+  int failures = 0;
+  for (const Budget& budget : Budgets) {
+    double perInstruction =
+        static_cast<double>(stats::get(budget.phase).allocations) /
+        instructions;
+    if (perInstruction > budget.perInstruction) {
+      std::cerr << "phase " << static_cast<int>(budget.phase) << ": "
+                << perInstruction << " allocations per instruction, "
+                << budget.perInstruction << " allowed\n";
+      ++failures;
+    }
+  }
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
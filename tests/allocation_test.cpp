@@ -0,0 +1,164 @@
+//===- allocation_test.cpp --------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2019 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+//
+// Checks that printing an instruction without label or CFI directive, with
+// or without symbolic operands, does not allocate from the heap: the first
+// time, when its operation is decoded and cached, only the resource of the
+// printer is used, and the second time nothing is allocated at all.
+//
+//===----------------------------------------------------------------------===//
+#include "AttPrettyPrinter.hpp"
+#include "IntelPrettyPrinter.hpp"
+
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory_resource>
+#include <new>
+#include <vector>
+
+static bool counting = false;
+static size_t allocations = 0;
+
+void* operator new(std::size_t size) {
+  if (counting)
+    ++allocations;
+  if (void* p = std::malloc(size ? size : 1))
+    return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+// Discards everything written to it.
+class NullBuffer : public std::streambuf {
+protected:
+  int overflow(int c) override { return c; }
+  std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+template <class Printer> class Probe : public Printer {
+public:
+  using Printer::Printer;
+  using Printer::decodeBlock;
+  using Printer::printInstruction;
+};
+
+// The resource of the printers, large enough for the caches of a test IR, so
+// that filling them never allocates from the heap.
+constexpr std::size_t ResourceSize = 64 << 20;
+
+bool isUnlabeled(const gtirb_pprint::PreparedModule& prepared,
+                 const cs_insn& inst, const gtirb::Offset& offset) {
+  const gtirb::Module& module = prepared.getModule();
+  if (!module.findSymbols(gtirb::Addr(inst.address)).empty())
+    return false;
+  const auto* cfiDirectives = prepared.getCFIDirectives();
+  return !cfiDirectives || cfiDirectives->count(offset) == 0;
+}
+
+bool isSymbolic(const gtirb::Module& module, const cs_insn& inst) {
+  gtirb::Addr ea(inst.address);
+  for (uint16_t i = 0; i < inst.size; ++i)
+    if (module.findSymbolicExpression(ea + i) != module.symbolic_expr_end())
+      return true;
+  return false;
+}
+
+// Print an instruction and return the number of heap allocations.
+template <class Printer>
+size_t countAllocations(Printer& printer, std::ostream& os,
+                        const cs_insn& inst, const gtirb::Offset& offset) {
+  allocations = 0;
+  counting = true;
+  printer.printInstruction(os, inst, offset);
+  counting = false;
+  return allocations;
+}
+
+struct Counts {
+  size_t plain = 0;
+  size_t symbolic = 0;
+  size_t failures = 0;
+};
+
+// Print each instruction twice, and count the instructions that allocated
+// from the heap either time.
+template <class Printer, class Syntax>
+void check(const gtirb_pprint::PreparedModule& prepared, const Syntax& syntax,
+           Counts& counts) {
+  const gtirb::Module& module = prepared.getModule();
+  std::vector<std::byte> memory(ResourceSize);
+  std::pmr::monotonic_buffer_resource resource(memory.data(), memory.size());
+  gtirb_pprint::PrintingPolicy policy;
+  Probe<Printer> printer(prepared, syntax, policy, &resource);
+  NullBuffer buffer;
+  std::ostream os(&buffer);
+  for (const gtirb::Block* block : prepared.getBlocks()) {
+    gtirb_pprint::DecodedInstructions insns = printer.decodeBlock(*block);
+    gtirb::Offset offset(block->getUUID(), 0);
+    for (size_t i = 0; i < insns.size(); ++i) {
+      const cs_insn& inst = insns[i];
+      if (isUnlabeled(prepared, inst, offset)) {
+        ++(isSymbolic(module, inst) ? counts.symbolic : counts.plain);
+        size_t first = countAllocations(printer, os, inst, offset);
+        size_t second = countAllocations(printer, os, inst, offset);
+        if (first != 0 || second != 0) {
+          ++counts.failures;
+          std::cerr << "0x" << std::hex << inst.address << std::dec << ' '
+                    << inst.mnemonic << ' ' << inst.op_str << ": " << first
+                    << " then " << second << " allocations\n";
+        }
+      }
+      offset.Displacement += inst.size;
+    }
+  }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  if (argc != 2) {
+    std::cerr << "usage: " << argv[0] << " IR\n";
+    return EXIT_FAILURE;
+  }
+  gtirb::Context ctx;
+  std::ifstream in(argv[1], std::ios::in | std::ios::binary);
+  gtirb::IR* ir = gtirb::IR::load(ctx, in);
+  if (!ir || ir->modules().empty()) {
+    std::cerr << "could not load " << argv[1] << '\n';
+    return EXIT_FAILURE;
+  }
+
+  Counts counts;
+  for (gtirb::Module& module : ir->modules()) {
+    gtirb_pprint::PreparedModule prepared(ctx, module);
+    check<gtirb_pprint::AttPrettyPrinter>(prepared, gtirb_pprint::ElfSyntax{},
+                                          counts);
+    check<gtirb_pprint::IntelPrettyPrinter>(
+        prepared, gtirb_pprint::IntelSyntax{}, counts);
+  }
+  std::cout << counts.plain << " plain and " << counts.symbolic
+            << " symbolic instructions checked, " << counts.failures
+            << " allocated\n";
+  return counts.plain > 0 && counts.symbolic > 0 && counts.failures == 0
+             ? EXIT_SUCCESS
+             : EXIT_FAILURE;
+}
@@ -0,0 +1,161 @@
+//===- att_adapt_test.cpp ---------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2019 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+//
+// Checks that the AT&T printer, when printing with the Intel printer and
+// adapting the instructions decoded for it, prints the same assembly as when
+// it decodes the instructions in AT&T syntax itself, for a module made of
+// instructions whose operands differ between the syntaxes (x87, string
+// operations, shifts by one, enter, far branches, implicit operands), and
+// for the modules of an optional IR.
+//
+//===----------------------------------------------------------------------===//
+#include "AttPrettyPrinter.hpp"
+#include "IntelPrettyPrinter.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using gtirb_pprint::AttPrettyPrinter;
+using gtirb_pprint::IntelPrettyPrinter;
+
+constexpr uint64_t TextAddress = 0x1000;
+
+const std::vector<std::vector<uint8_t>> Code{
+    {0xd8, 0xc1},                         // fadd st(0), st(1)
+    {0xdc, 0xe9},                         // fsub st(1), st(0)
+    {0xdc, 0xf9},                         // fdiv st(1), st(0)
+    {0xde, 0xe9},                         // fsubp st(1), st(0)
+    {0xde, 0xf1},                         // fdivrp st(1), st(0)
+    {0xd9, 0xc9},                         // fxch st(1)
+    {0xd8, 0xd1},                         // fcom st(1)
+    {0xdd, 0x45, 0x08},                   // fld qword ptr [rbp+8]
+    {0xdf, 0xe0},                         // fnstsw ax
+    {0xa4},                               // movsb
+    {0xf3, 0x48, 0xa5},                   // rep movsq
+    {0xaa},                               // stosb
+    {0xf3, 0xa6},                         // repe cmpsb
+    {0xac},                               // lodsb
+    {0xae},                               // scasb
+    {0x6c},                               // insb
+    {0x6e},                               // outsb
+    {0xd1, 0xe0},                         // shl eax, 1
+    {0xd0, 0xf8},                         // sar al, 1
+    {0x48, 0xd1, 0xe8},                   // shr rax, 1
+    {0xd1, 0xc1},                         // rol ecx, 1
+    {0xd3, 0xe0},                         // shl eax, cl
+    {0x0f, 0xa4, 0xc3, 0x04},             // shld ebx, eax, 4
+    {0xc8, 0x10, 0x00, 0x01},             // enter 16, 1
+    {0xc9},                               // leave
+    {0xff, 0x18},                         // call far [rax]
+    {0x48, 0xff, 0x18},                   // call far [rax], 64-bit pointer
+    {0xff, 0x2b},                         // jmp far [rbx]
+    {0xca, 0x08, 0x00},                   // retf 8
+    {0xf7, 0xe3},                         // mul ebx
+    {0xf7, 0xfb},                         // idiv ebx
+    {0x6b, 0xc3, 0x05},                   // imul eax, ebx, 5
+    {0x48, 0x99},                         // cqo
+    {0x48, 0x98},                         // cdqe
+    {0x0f, 0xa2},                         // cpuid
+    {0x0f, 0x31},                         // rdtsc
+    {0x9c},                               // pushfq
+    {0xd7},                               // xlatb
+    {0xec},                               // in al, dx
+    {0xee},                               // out dx, al
+    {0x0f, 0xc7, 0x0e},                   // cmpxchg8b [rsi]
+    {0x48, 0x0f, 0xc1, 0x03},             // xadd [rbx], rax
+    {0x66, 0x0f, 0x3a, 0x0f, 0xc1, 0x08}, // palignr xmm0, xmm1, 8
+    {0xc4, 0xe3, 0x79, 0x4a, 0xc2, 0x30}, // vblendvps xmm0, xmm0, xmm2, xmm3
+    {0xc3},                               // ret
+};
+
+// Build a module whose single block is Code.
+gtirb::Module* buildModule(gtirb::Context& ctx) {
+  gtirb::Module* module = gtirb::Module::Create(ctx);
+  module->setFileFormat(gtirb::FileFormat::ELF);
+  module->setISAID(gtirb::ISAID::X64);
+
+  std::vector<std::byte> text;
+  for (const std::vector<uint8_t>& bytes : Code)
+    for (uint8_t b : bytes)
+      text.push_back(static_cast<std::byte>(b));
+
+  gtirb::ImageByteMap& image = module->getImageByteMap();
+  image.setAddrMinMax(
+      {gtirb::Addr(TextAddress), gtirb::Addr(TextAddress + text.size())});
+  image.setData(gtirb::Addr(TextAddress),
+                gsl::span<const std::byte>(text.data(), text.size()));
+  module->addSection(gtirb::Section::Create(ctx, ".text",
+                                            gtirb::Addr(TextAddress),
+                                            text.size()));
+  gtirb::emplaceBlock(module->getCFG(), ctx, gtirb::Addr(TextAddress),
+                      text.size());
+  return module;
+}
+
+size_t failures = 0;
+
+void check(gtirb::Context& ctx, gtirb::Module& module,
+           const std::string& name) {
+  static const gtirb_pprint::ElfSyntax attSyntax{};
+  static const gtirb_pprint::IntelSyntax intelSyntax{};
+  gtirb_pprint::PreparedModule prepared(ctx, module);
+  const gtirb_pprint::PrintingPolicy& policy =
+      gtirb_pprint::ElfPrettyPrinter::defaultPrintingPolicy();
+
+  std::ostringstream native;
+  AttPrettyPrinter(prepared, attSyntax, policy).print(native);
+
+  AttPrettyPrinter att(prepared, attSyntax, policy);
+  IntelPrettyPrinter intel(prepared, intelSyntax, policy);
+  std::ostringstream adapted, intelText;
+  gtirb_pprint::PrettyPrinterBase::printAll(
+      {{&intel, &intelText}, {&att, &adapted}});
+
+  if (native.str().empty() || adapted.str() != native.str()) {
+    ++failures;
+    std::cerr << name
+              << ": the adapted AT&T output differs from the AT&T decode\n";
+  }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  if (argc > 2) {
+    std::cerr << "usage: " << argv[0] << " [IR]\n";
+    return EXIT_FAILURE;
+  }
+
+  gtirb::Context ctx;
+  check(ctx, *buildModule(ctx), "operand forms");
+
+  if (argc == 2) {
+    std::ifstream in(argv[1], std::ios::in | std::ios::binary);
+    gtirb::IR* ir = gtirb::IR::load(ctx, in);
+    if (!ir || ir->modules().empty()) {
+      std::cerr << "could not load " << argv[1] << '\n';
+      return EXIT_FAILURE;
+    }
+    for (gtirb::Module& module : ir->modules())
+      check(ctx, module, "module " + module.getName());
+  }
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
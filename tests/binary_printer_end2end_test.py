@@ -1,3 +1,5 @@
+import json
+import shutil
 import unittest
 from pathlib import Path
 import subprocess
@@ -14,4 +16,44 @@ class TestBinaryGeneration(unittest.TestCase):
             '--compiler-args','-no-pie']).decode(sys.stdout.encoding)
         self.assertTrue('Calling compiler' in output)
         output_bin = subprocess.check_output('/tmp/two_modules').decode(sys.stdout.encoding)
-        self.assertTrue('!!!Hello World!!!' in output_bin)
\ No newline at end of file
+        self.assertTrue('!!!Hello World!!!' in output_bin)
+
+    def test_generate_binary_direct_objects(self):
+        output= subprocess.check_output(['gtirb-binary-printer',
+            '--ir',str(two_modules_gtirb),
+            '-b','/tmp/two_modules_direct',
+            '--direct-objects',
+            '--compiler-args','-no-pie']).decode(sys.stdout.encoding)
+        self.assertTrue('Calling compiler' in output)
+        output_bin = subprocess.check_output('/tmp/two_modules_direct').decode(sys.stdout.encoding)
+        self.assertTrue('!!!Hello World!!!' in output_bin)
+
+    def test_trace_compiler_run(self):
+        subprocess.check_output(['gtirb-binary-printer',
+            '--ir',str(two_modules_gtirb),
+            '-b','/tmp/two_modules_traced',
+            '--trace','/tmp/binary_printer_trace.json',
+            '--compiler-args','-no-pie'])
+        with open('/tmp/binary_printer_trace.json', 'r') as f:
+            events = json.load(f)['traceEvents']
+        categories = [event['cat'] for event in events]
+        self.assertEqual(categories.count('process'), 1)
+        self.assertEqual(categories.count('io'), 3)
+
+    def test_cached_rebuild(self):
+        shutil.rmtree('/tmp/binary_printer_cache', ignore_errors=True)
+        def build():
+            return subprocess.check_output(['gtirb-binary-printer',
+                '--ir',str(two_modules_gtirb),
+                '-b','/tmp/two_modules_cached',
+                '--cache-dir','/tmp/binary_printer_cache',
+                '--compiler-args','-no-pie']).decode(sys.stdout.encoding)
+        output = build()
+        self.assertTrue('Calling compiler' in output)
+        self.assertFalse('Reusing cached' in output)
+        output = build()
+        self.assertEqual(output.count('Reusing cached object'), 2)
+        self.assertTrue('Reusing cached binary' in output)
+        self.assertFalse('Calling compiler' in output)
+        output_bin = subprocess.check_output('/tmp/two_modules_cached').decode(sys.stdout.encoding)
+        self.assertTrue('!!!Hello World!!!' in output_bin)
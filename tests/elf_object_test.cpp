@@ -0,0 +1,266 @@
+//===- elf_object_test.cpp --------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2019 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+//
+// Checks the relocations and sections of the objects written by
+// ElfObjectBinaryPrinter for a small module with one reference of each kind,
+// and that the references it cannot express are rejected.
+//
+//===----------------------------------------------------------------------===//
+#include "ElfObjectBinaryPrinter.hpp"
+#include "PrettyPrinter.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <elf.h>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+constexpr uint64_t TextAddress = 0x1000;
+constexpr uint64_t PltAddress = 0x2000;
+constexpr uint64_t GotAddress = 0x2100;
+constexpr uint64_t DataAddress = 0x3000;
+constexpr uint64_t RodataAddress = 0x4000;
+constexpr uint64_t TbssAddress = 0x5000;
+
+// The code of the module, one instruction per reference form. Each entry is
+// the instruction bytes and the offset of its relocated field.
+const std::vector<std::pair<std::vector<uint8_t>, uint8_t>> Code{
+    {{0xe8, 0, 0, 0, 0}, 1},                   // call puts@PLT
+    {{0x48, 0x8d, 0x05, 0, 0, 0, 0}, 3},       // lea value(%rip),%rax
+    {{0x48, 0x8b, 0x05, 0, 0, 0, 0}, 3},       // mov stdout@GOTPCREL(%rip),%rax
+    {{0xbf, 0, 0, 0, 0}, 1},                   // mov $value+2,%edi
+    {{0x48, 0xc7, 0xc0, 0, 0, 0, 0}, 3},       // mov $value,%rax
+    {{0xc3}, 0},                               // ret
+};
+
+enum class Variant { Valid, AbsoluteGot, ThreadLocal };
+
+// Build a module with .text, .data, .rodata and .tbss sections, and .plt and
+// .got sections whose symbols are forwarded to external ones. The fourth
+// instruction refers to a GOT entry or to a thread-local variable in the
+// invalid variants.
+gtirb::Module* buildModule(gtirb::Context& ctx, Variant variant) {
+  gtirb::Module* module = gtirb::Module::Create(ctx);
+  module->setFileFormat(gtirb::FileFormat::ELF);
+  module->setISAID(gtirb::ISAID::X64);
+
+  std::vector<std::byte> text;
+  for (const auto& [bytes, field] : Code)
+    for (uint8_t b : bytes)
+      text.push_back(static_cast<std::byte>(b));
+  std::vector<std::byte> data(16, std::byte{0});
+  std::vector<std::byte> rodata(8, std::byte{0x2a});
+
+  gtirb::ImageByteMap& image = module->getImageByteMap();
+  image.setAddrMinMax({gtirb::Addr(TextAddress), gtirb::Addr(TbssAddress)});
+  image.setData(gtirb::Addr(TextAddress),
+                gsl::span<const std::byte>(text.data(), text.size()));
+  image.setData(gtirb::Addr(DataAddress),
+                gsl::span<const std::byte>(data.data(), data.size()));
+  image.setData(gtirb::Addr(RodataAddress),
+                gsl::span<const std::byte>(rodata.data(), rodata.size()));
+
+  module->addSection(gtirb::Section::Create(ctx, ".text",
+                                            gtirb::Addr(TextAddress),
+                                            text.size()));
+  module->addSection(
+      gtirb::Section::Create(ctx, ".plt", gtirb::Addr(PltAddress), 16));
+  module->addSection(
+      gtirb::Section::Create(ctx, ".got", gtirb::Addr(GotAddress), 8));
+  module->addSection(gtirb::Section::Create(ctx, ".data",
+                                            gtirb::Addr(DataAddress),
+                                            data.size()));
+  module->addSection(gtirb::Section::Create(ctx, ".rodata",
+                                            gtirb::Addr(RodataAddress),
+                                            rodata.size()));
+  module->addSection(
+      gtirb::Section::Create(ctx, ".tbss", gtirb::Addr(TbssAddress), 8));
+
+  gtirb::emplaceBlock(module->getCFG(), ctx, gtirb::Addr(TextAddress),
+                      text.size());
+  module->addData(gtirb::DataObject::Create(ctx, gtirb::Addr(DataAddress), 8));
+  module->addData(
+      gtirb::DataObject::Create(ctx, gtirb::Addr(DataAddress + 8), 8));
+  module->addData(
+      gtirb::DataObject::Create(ctx, gtirb::Addr(RodataAddress), 8));
+  module->addData(gtirb::DataObject::Create(ctx, gtirb::Addr(TbssAddress), 8));
+
+  auto* value =
+      gtirb::Symbol::Create(ctx, gtirb::Addr(DataAddress + 8), "value",
+                            gtirb::Symbol::StorageKind::Local);
+  auto* plt = gtirb::Symbol::Create(ctx, gtirb::Addr(PltAddress), "puts_plt");
+  auto* got = gtirb::Symbol::Create(ctx, gtirb::Addr(GotAddress), "stdout_got");
+  auto* puts = gtirb::Symbol::Create(ctx, "puts");
+  auto* out = gtirb::Symbol::Create(ctx, "stdout");
+  auto* tls = gtirb::Symbol::Create(ctx, gtirb::Addr(TbssAddress), "counter",
+                                    gtirb::Symbol::StorageKind::Local);
+  for (gtirb::Symbol* symbol : {value, plt, got, puts, out, tls})
+    module->addSymbol(symbol);
+  module->addAuxData("symbolForwarding",
+                     std::map<gtirb::UUID, gtirb::UUID>{
+                         {plt->getUUID(), puts->getUUID()},
+                         {got->getUUID(), out->getUUID()}});
+
+  gtirb::Symbol* fourth = value;
+  if (variant == Variant::AbsoluteGot)
+    fourth = got;
+  else if (variant == Variant::ThreadLocal)
+    fourth = tls;
+  std::vector<std::pair<gtirb::Symbol*, int64_t>> references{
+      {plt, 0}, {value, 0}, {got, 0}, {fourth, 2}, {value, 0}};
+  uint64_t ea = TextAddress;
+  for (size_t i = 0; i < references.size(); ++i) {
+    module->addSymbolicExpression<gtirb::SymAddrConst>(
+        gtirb::Addr(ea + Code[i].second), references[i].second,
+        references[i].first);
+    ea += Code[i].first.size();
+  }
+  module->addSymbolicExpression<gtirb::SymAddrConst>(gtirb::Addr(DataAddress),
+                                                     4, value);
+  return module;
+}
+
+struct Relocation {
+  std::string section;
+  uint64_t offset;
+  uint32_t type;
+  std::string symbol;
+  int64_t addend;
+
+  bool operator<(const Relocation& other) const {
+    return std::tie(section, offset) < std::tie(other.section, other.offset);
+  }
+};
+
+template <class T> T read(const std::string& image, uint64_t offset) {
+  T value;
+  std::memcpy(&value, image.data() + offset, sizeof(T));
+  return value;
+}
+
+// The relocations of an object, with the names of the sections they apply to
+// and of their symbols (the section name for section symbols), and the flags
+// of every section.
+void readObject(const std::string& image, std::vector<Relocation>& relocations,
+                std::map<std::string, uint64_t>& flags) {
+  auto ehdr = read<Elf64_Ehdr>(image, 0);
+  std::vector<Elf64_Shdr> headers;
+  for (uint16_t i = 0; i < ehdr.e_shnum; ++i)
+    headers.push_back(
+        read<Elf64_Shdr>(image, ehdr.e_shoff + i * sizeof(Elf64_Shdr)));
+  auto name = [&](const Elf64_Shdr& strtab, uint32_t offset) {
+    return std::string(image.c_str() + strtab.sh_offset + offset);
+  };
+  auto sectionName = [&](uint32_t index) {
+    return name(headers[ehdr.e_shstrndx], headers[index].sh_name);
+  };
+  for (uint16_t i = 1; i < headers.size(); ++i)
+    flags[sectionName(i)] = headers[i].sh_flags;
+
+  for (const Elf64_Shdr& header : headers) {
+    if (header.sh_type != SHT_RELA)
+      continue;
+    const Elf64_Shdr& symtab = headers[header.sh_link];
+    for (uint64_t offset = 0; offset < header.sh_size;
+         offset += sizeof(Elf64_Rela)) {
+      auto rela = read<Elf64_Rela>(image, header.sh_offset + offset);
+      auto sym = read<Elf64_Sym>(image, symtab.sh_offset +
+                                            ELF64_R_SYM(rela.r_info) *
+                                                sizeof(Elf64_Sym));
+      std::string symbol = ELF64_ST_TYPE(sym.st_info) == STT_SECTION
+                               ? sectionName(sym.st_shndx)
+                               : name(headers[symtab.sh_link], sym.st_name);
+      relocations.push_back({sectionName(header.sh_info), rela.r_offset,
+                             static_cast<uint32_t>(ELF64_R_TYPE(rela.r_info)),
+                             symbol, rela.r_addend});
+    }
+  }
+  std::sort(relocations.begin(), relocations.end());
+}
+
+size_t failures = 0;
+
+void expect(bool condition, const std::string& message) {
+  if (!condition) {
+    std::cerr << message << '\n';
+    ++failures;
+  }
+}
+
+} // namespace
+
+int main() {
+  gtirb_pprint::PrettyPrinter pp;
+  gtirb_bprint::ElfObjectBinaryPrinter printer;
+
+  gtirb::Context ctx;
+  std::ostringstream object;
+  expect(printer.writeObject(object, pp, ctx,
+                             *buildModule(ctx, Variant::Valid)),
+         "the object could not be written");
+  std::vector<Relocation> relocations;
+  std::map<std::string, uint64_t> flags;
+  readObject(object.str(), relocations, flags);
+
+  // Pc-relative fields are relative to the end of the instruction, 4 bytes
+  // after the field here; "value" is at offset 8 of .data.
+  const std::vector<Relocation> expected{
+      {".data", 0, R_X86_64_64, ".data", 8 + 4},
+      {".text", 1, R_X86_64_PLT32, "puts", -4},
+      {".text", 8, R_X86_64_PC32, ".data", 8 - 4},
+      {".text", 15, R_X86_64_GOTPCREL, "stdout", -4},
+      {".text", 20, R_X86_64_32, ".data", 8 + 2},
+      {".text", 27, R_X86_64_32S, ".data", 8},
+  };
+  expect(relocations.size() == expected.size(),
+         std::to_string(relocations.size()) + " relocations instead of " +
+             std::to_string(expected.size()));
+  for (size_t i = 0; i < std::min(relocations.size(), expected.size()); ++i) {
+    const Relocation& r = relocations[i];
+    const Relocation& e = expected[i];
+    expect(r.section == e.section && r.offset == e.offset &&
+               r.type == e.type && r.symbol == e.symbol &&
+               r.addend == e.addend,
+           r.section + "+" + std::to_string(r.offset) + ": type " +
+               std::to_string(r.type) + " against " + r.symbol + "+" +
+               std::to_string(r.addend) + ", expected " + e.section + "+" +
+               std::to_string(e.offset) + ": type " + std::to_string(e.type) +
+               " against " + e.symbol + "+" + std::to_string(e.addend));
+  }
+
+  // Without elfSectionProperties, the flags the assembler would use.
+  expect(flags[".text"] == (SHF_ALLOC | SHF_EXECINSTR), ".text flags");
+  expect(flags[".data"] == (SHF_ALLOC | SHF_WRITE), ".data flags");
+  expect(flags[".rodata"] == SHF_ALLOC, ".rodata flags");
+  expect(flags[".tbss"] == (SHF_ALLOC | SHF_WRITE | SHF_TLS), ".tbss flags");
+
+  for (Variant variant : {Variant::AbsoluteGot, Variant::ThreadLocal}) {
+    gtirb::Context invalidCtx;
+    std::ostringstream invalid;
+    expect(!printer.writeObject(invalid, pp, invalidCtx,
+                                *buildModule(invalidCtx, variant)),
+           variant == Variant::AbsoluteGot
+               ? "an absolute reference to a GOT entry was accepted"
+               : "a reference to a thread-local variable was accepted");
+  }
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
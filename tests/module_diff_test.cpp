@@ -0,0 +1,153 @@
+//===- module_diff_test.cpp -------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2019 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+//
+// Checks the diff of two versions of a module, the second loaded from a copy
+// of the first and then edited: a block whose bytes changed, a block whose
+// bytes are the same but whose symbolic operand refers to a renamed symbol, a
+// data object only in the first version and one only in the second.
+//
+//===----------------------------------------------------------------------===//
+#include "ModuleDiff.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr uint64_t MainAddress = 0x1000;
+constexpr uint64_t HelperAddress = 0x1010;
+constexpr uint64_t DataAddress = 0x3000;
+
+// main: mov $first,%eax; ret
+// helper: mov $1,%eax; ret
+const std::vector<uint8_t> Main{0xb8, 0x10, 0x10, 0, 0, 0xc3};
+const std::vector<uint8_t> Helper{0xb8, 1, 0, 0, 0, 0xc3};
+
+void setBytes(gtirb::Module& module, uint64_t address,
+              const std::vector<uint8_t>& bytes) {
+  std::vector<std::byte> data;
+  for (uint8_t b : bytes)
+    data.push_back(static_cast<std::byte>(b));
+  module.getImageByteMap().setData(
+      gtirb::Addr(address),
+      gsl::span<const std::byte>(data.data(), data.size()));
+}
+
+// Build a module with main and helper in .text, and in .data a pointer to
+// helper and a plain quad word. Two symbols name helper: main refers to the
+// first, the pointer to the second.
+gtirb::IR* buildIR(gtirb::Context& ctx) {
+  gtirb::IR* ir = gtirb::IR::Create(ctx);
+  gtirb::Module* module = gtirb::Module::Create(ctx);
+  ir->addModule(module);
+  module->setFileFormat(gtirb::FileFormat::ELF);
+  module->setISAID(gtirb::ISAID::X64);
+
+  module->getImageByteMap().setAddrMinMax(
+      {gtirb::Addr(MainAddress), gtirb::Addr(DataAddress + 32)});
+  setBytes(*module, MainAddress, Main);
+  setBytes(*module, HelperAddress, Helper);
+  setBytes(*module, DataAddress, std::vector<uint8_t>(32, 0));
+  setBytes(*module, DataAddress + 8, {1, 0, 0, 0, 0, 0, 0, 0});
+
+  module->addSection(gtirb::Section::Create(ctx, ".text",
+                                            gtirb::Addr(MainAddress),
+                                            HelperAddress + 16 - MainAddress));
+  module->addSection(
+      gtirb::Section::Create(ctx, ".data", gtirb::Addr(DataAddress), 32));
+  gtirb::emplaceBlock(module->getCFG(), ctx, gtirb::Addr(MainAddress),
+                      Main.size());
+  gtirb::emplaceBlock(module->getCFG(), ctx, gtirb::Addr(HelperAddress),
+                      Helper.size());
+  module->addData(gtirb::DataObject::Create(ctx, gtirb::Addr(DataAddress), 8));
+  module->addData(
+      gtirb::DataObject::Create(ctx, gtirb::Addr(DataAddress + 8), 8));
+
+  auto* first = gtirb::Symbol::Create(ctx, gtirb::Addr(HelperAddress), "first",
+                                      gtirb::Symbol::StorageKind::Local);
+  auto* second = gtirb::Symbol::Create(
+      ctx, gtirb::Addr(HelperAddress), "second",
+      gtirb::Symbol::StorageKind::Local);
+  module->addSymbol(first);
+  module->addSymbol(second);
+  module->addSymbolicExpression<gtirb::SymAddrConst>(
+      gtirb::Addr(MainAddress + 1), 0, first);
+  module->addSymbolicExpression<gtirb::SymAddrConst>(gtirb::Addr(DataAddress),
+                                                     0, second);
+  return ir;
+}
+
+size_t failures = 0;
+
+void expect(bool condition, const std::string& message) {
+  if (!condition) {
+    std::cerr << message << '\n';
+    ++failures;
+  }
+}
+
+} // namespace
+
+int main() {
+  gtirb::Context oldContext;
+  gtirb::IR* oldIR = buildIR(oldContext);
+  std::stringstream saved;
+  oldIR->save(saved);
+  gtirb::Context newContext;
+  gtirb::IR* newIR = gtirb::IR::load(newContext, saved);
+  gtirb::Module& oldModule = *oldIR->modules().begin();
+  gtirb::Module& newModule = *newIR->modules().begin();
+
+  // Only in the old version: a data object added after the copy.
+  setBytes(oldModule, DataAddress + 16, {2, 0, 0, 0, 0, 0, 0, 0});
+  oldModule.addData(
+      gtirb::DataObject::Create(oldContext, gtirb::Addr(DataAddress + 16), 8));
+
+  // In the new version: helper returns 2, the first symbol is renamed, and a
+  // data object is added.
+  setBytes(newModule, HelperAddress + 1, {2});
+  for (gtirb::Symbol& symbol : newModule.findSymbols("first"))
+    symbol.setName("renamed");
+  setBytes(newModule, DataAddress + 24, {3, 0, 0, 0, 0, 0, 0, 0});
+  newModule.addData(
+      gtirb::DataObject::Create(newContext, gtirb::Addr(DataAddress + 24), 8));
+
+  gtirb_pprint::PrettyPrinter pp;
+  std::ostringstream diff;
+  gtirb_pprint::DiffSummary summary = gtirb_pprint::printDiff(
+      diff, pp, gtirb_pprint::PreparedModule(oldContext, oldModule),
+      gtirb_pprint::PreparedModule(newContext, newModule));
+  const std::string text = diff.str();
+
+  expect(summary.changed == 2, "main and helper are not both changed");
+  expect(summary.added == 1, "the new data object is not added");
+  expect(summary.removed == 1, "the old data object is not removed");
+  expect(summary.unchanged == 2, "the data objects in both are not unchanged");
+  for (const char* header : {"@@ changed block 0x1000 -> 0x1000",
+                             "@@ changed block 0x1010 -> 0x1010",
+                             "@@ removed data object 0x3010",
+                             "@@ added data object 0x3018"})
+    expect(text.find(header) != std::string::npos,
+           std::string("the diff lacks ") + header);
+  expect(text.find("$renamed") != std::string::npos,
+         "the diff lacks the operand of main with the renamed symbol");
+  expect(text.find(".quad second") == std::string::npos,
+         "the diff shows the unchanged pointer to the second symbol");
+
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,78 @@
+//===- number_format_test.cpp -----------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2019 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+//
+// Checks that the integer formatting of the printers writes the same text as
+// the stream formatting, for the limits, the powers of the bases and random
+// values.
+//
+//===----------------------------------------------------------------------===//
+#include "NumberFormat.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace nf = gtirb_pprint::number_format;
+
+static size_t failures = 0;
+
+static void check(uint64_t value) {
+  std::ostringstream expected, actual;
+  expected << std::hex << value << ' ' << std::dec
+           << static_cast<int64_t>(value) << ' ' << value;
+  nf::writeHex(actual, value);
+  actual << ' ';
+  nf::writeDecimal(actual, static_cast<int64_t>(value));
+  char buffer[nf::MaxDecimalSize];
+  actual << ' '
+         << std::string(buffer, nf::formatDecimal(buffer, value) - buffer);
+  if (actual.str() != expected.str()) {
+    std::cerr << "expected '" << expected.str() << "', got '" << actual.str()
+              << "'\n";
+    ++failures;
+  }
+}
+
+int main() {
+  std::vector<uint64_t> values{
+      0, std::numeric_limits<uint64_t>::max(),
+      static_cast<uint64_t>(std::numeric_limits<int64_t>::max()),
+      static_cast<uint64_t>(std::numeric_limits<int64_t>::min())};
+  for (uint64_t power = 1; power != 0; power <<= 1)
+    values.push_back(power);
+  for (uint64_t power = 1; power <= 1000000000000000000; power *= 10)
+    values.push_back(power);
+  size_t powers = values.size();
+  for (size_t i = 0; i < powers; ++i) {
+    values.push_back(values[i] - 1);
+    values.push_back(values[i] + 1);
+    values.push_back(0 - values[i]);
+  }
+  std::mt19937_64 random(0);
+  for (int i = 0; i < 100000; ++i)
+    values.push_back(random() >> (random() % 64));
+
+  for (uint64_t value : values)
+    check(value);
+  if (failures != 0) {
+    std::cerr << failures << " of " << values.size() << " values differ\n";
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,176 @@
+//===- operation_cache_test.cpp ---------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2019 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+//
+// Checks that the printers, which decode instructions without details and
+// print the operations that only depend on their bytes from a cache, print
+// the same assembly as printers that decode every instruction with details,
+// for a module made of branches and repeated instructions with and without
+// symbolic operands, and for the modules of an optional IR.
+//
+//===----------------------------------------------------------------------===//
+#include "AttPrettyPrinter.hpp"
+#include "IntelPrettyPrinter.hpp"
+#include "StaticPrettyPrinter.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using gtirb_pprint::AttPrettyPrinter;
+using gtirb_pprint::DecodedInstructions;
+using gtirb_pprint::ElfSyntax;
+using gtirb_pprint::IntelPrettyPrinter;
+using gtirb_pprint::IntelSyntax;
+using gtirb_pprint::StaticPrettyPrinter;
+
+constexpr uint64_t TextAddress = 0x1000;
+constexpr uint64_t Repetitions = 64;
+
+// A printer that decodes every instruction with details, so that none of
+// them is printed from the cache.
+template <class Printer> class Detailed : public Printer {
+public:
+  using Printer::Printer;
+
+protected:
+  DecodedInstructions decodeBlock(const gtirb::Block& x) override {
+    return DecodedInstructions::decode(this->csHandle, this->module, x);
+  }
+};
+
+// The repeated code of the module. Each entry is the instruction bytes and
+// the offset of its symbolic operand, or 0 for none.
+const std::vector<std::pair<std::vector<uint8_t>, uint8_t>> Code{
+    {{0x0f, 0x85, 0, 0, 0, 0}, 0},       // jne .+6
+    {{0x0f, 0x84, 0, 0, 0, 0}, 2},       // je target
+    {{0x74, 0x00}, 0},                   // je .+2
+    {{0xe3, 0x00}, 0},                   // jrcxz .+2
+    {{0xe2, 0x00}, 0},                   // loop .+2
+    {{0xeb, 0x00}, 0},                   // jmp .+2
+    {{0xe9, 0, 0, 0, 0}, 1},             // jmp target
+    {{0xe8, 0, 0, 0, 0}, 0},             // call .+5
+    {{0x66, 0xe8, 0, 0, 0, 0}, 0},       // call .+6, with a prefix
+    {{0xe8, 0, 0, 0, 0}, 1},             // call target
+    {{0xff, 0xd0}, 0},                   // call *%rax
+    {{0x41, 0xff, 0xe3}, 0},             // jmp *%r11
+    {{0xb8, 1, 0, 0, 0}, 0},             // mov $1,%eax
+    {{0xb8, 1, 0, 0, 0}, 1},             // mov $target+1,%eax
+    {{0x48, 0x8b, 0x05, 0, 0, 0, 0}, 0}, // mov 0(%rip),%rax
+    {{0x48, 0x8b, 0x05, 0, 0, 0, 0}, 3}, // mov target(%rip),%rax
+    {{0xc7, 0x40, 0x08, 0, 0, 0, 0}, 3}, // movl $target,8(%rax)
+    {{0x48, 0x01, 0xd8}, 0},             // add %rbx,%rax
+};
+
+// Build a module whose single block repeats Code, so that the same bytes
+// are printed at many addresses, with a symbol for the symbolic operands.
+gtirb::Module* buildModule(gtirb::Context& ctx) {
+  gtirb::Module* module = gtirb::Module::Create(ctx);
+  module->setFileFormat(gtirb::FileFormat::ELF);
+  module->setISAID(gtirb::ISAID::X64);
+
+  std::vector<std::byte> text;
+  for (uint64_t i = 0; i < Repetitions; ++i)
+    for (const auto& [bytes, field] : Code)
+      for (uint8_t b : bytes)
+        text.push_back(static_cast<std::byte>(b));
+
+  gtirb::ImageByteMap& image = module->getImageByteMap();
+  image.setAddrMinMax(
+      {gtirb::Addr(TextAddress), gtirb::Addr(TextAddress + text.size())});
+  image.setData(gtirb::Addr(TextAddress),
+                gsl::span<const std::byte>(text.data(), text.size()));
+  module->addSection(gtirb::Section::Create(ctx, ".text",
+                                            gtirb::Addr(TextAddress),
+                                            text.size()));
+  gtirb::emplaceBlock(module->getCFG(), ctx, gtirb::Addr(TextAddress),
+                      text.size());
+
+  auto* target = gtirb::Symbol::Create(ctx, gtirb::Addr(TextAddress),
+                                       "target",
+                                       gtirb::Symbol::StorageKind::Local);
+  module->addSymbol(target);
+  uint64_t ea = TextAddress;
+  for (uint64_t i = 0; i < Repetitions; ++i) {
+    for (const auto& [bytes, field] : Code) {
+      if (field != 0)
+        module->addSymbolicExpression<gtirb::SymAddrConst>(
+            gtirb::Addr(ea + field), bytes[0] == 0xb8 ? 1 : 0, target);
+      ea += bytes.size();
+    }
+  }
+  return module;
+}
+
+// Print a module in AT&T and Intel syntax.
+template <class Att, class Intel>
+std::vector<std::string> print(const gtirb_pprint::PreparedModule& prepared) {
+  static const ElfSyntax attSyntax{};
+  static const IntelSyntax intelSyntax{};
+  const gtirb_pprint::PrintingPolicy& policy =
+      gtirb_pprint::ElfPrettyPrinter::defaultPrintingPolicy();
+  std::ostringstream attText, intelText;
+  Att(prepared, attSyntax, policy).print(attText);
+  Intel(prepared, intelSyntax, policy).print(intelText);
+  return {attText.str(), intelText.str()};
+}
+
+size_t failures = 0;
+
+void check(gtirb::Context& ctx, gtirb::Module& module,
+           const std::string& name) {
+  gtirb_pprint::PreparedModule prepared(ctx, module);
+  std::vector<std::string> expected =
+      print<Detailed<AttPrettyPrinter>, Detailed<IntelPrettyPrinter>>(
+          prepared);
+  std::vector<std::string> actual =
+      print<StaticPrettyPrinter<AttPrettyPrinter>,
+            StaticPrettyPrinter<IntelPrettyPrinter>>(prepared);
+  for (size_t i = 0; i < expected.size(); ++i) {
+    if (expected[i].empty() || actual[i] != expected[i]) {
+      ++failures;
+      std::cerr << name << ", " << (i == 0 ? "att" : "intel")
+                << ": the cached operations differ from the detailed ones\n";
+    }
+  }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  if (argc > 2) {
+    std::cerr << "usage: " << argv[0] << " [IR]\n";
+    return EXIT_FAILURE;
+  }
+
+  gtirb::Context ctx;
+  check(ctx, *buildModule(ctx), "branches");
+
+  if (argc == 2) {
+    std::ifstream in(argv[1], std::ios::in | std::ios::binary);
+    gtirb::IR* ir = gtirb::IR::load(ctx, in);
+    if (!ir || ir->modules().empty()) {
+      std::cerr << "could not load " << argv[1] << '\n';
+      return EXIT_FAILURE;
+    }
+    for (gtirb::Module& module : ir->modules())
+      check(ctx, module, "module " + module.getName());
+  }
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,183 @@
+//===- partial_print_test.cpp -----------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2019 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+//
+// Checks that the printers of a partially prepared module skip the same
+// functions as a full print, for a module whose .init_array and .data refer
+// to a function skipped by default in another section: streaming, chunk
+// generation, and printing a range or a function.
+//
+//===----------------------------------------------------------------------===//
+#include "ChunkGenerator.hpp"
+#include "PrettyPrinter.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr uint64_t TextAddress = 0x1000;
+constexpr uint64_t MainAddress = 0x1010;
+constexpr uint64_t InitArrayAddress = 0x2000;
+constexpr uint64_t DataAddress = 0x3000;
+
+// frame_dummy: ret, padded to 16 bytes.
+// main: mov $frame_dummy,%eax; ret
+const std::vector<uint8_t> FrameDummy{0xc3, 0x90, 0x90, 0x90, 0x90, 0x90,
+                                      0x90, 0x90, 0x90, 0x90, 0x90, 0x90,
+                                      0x90, 0x90, 0x90, 0x90};
+const std::vector<uint8_t> Main{0xb8, 0, 0, 0, 0, 0xc3};
+
+using FunctionTable = std::map<gtirb::UUID, std::set<gtirb::UUID>>;
+
+// Build a module with frame_dummy and main in .text, .init_array entries for
+// both, and a pointer to frame_dummy in .data.
+gtirb::Module* buildModule(gtirb::Context& ctx) {
+  gtirb::Module* module = gtirb::Module::Create(ctx);
+  module->setFileFormat(gtirb::FileFormat::ELF);
+  module->setISAID(gtirb::ISAID::X64);
+
+  std::vector<std::byte> text;
+  for (const auto* bytes : {&FrameDummy, &Main})
+    for (uint8_t b : *bytes)
+      text.push_back(static_cast<std::byte>(b));
+  std::vector<std::byte> zeros(16, std::byte{0});
+
+  gtirb::ImageByteMap& image = module->getImageByteMap();
+  image.setAddrMinMax(
+      {gtirb::Addr(TextAddress), gtirb::Addr(DataAddress + zeros.size())});
+  image.setData(gtirb::Addr(TextAddress),
+                gsl::span<const std::byte>(text.data(), text.size()));
+  image.setData(gtirb::Addr(InitArrayAddress),
+                gsl::span<const std::byte>(zeros.data(), zeros.size()));
+  image.setData(gtirb::Addr(DataAddress),
+                gsl::span<const std::byte>(zeros.data(), 8));
+
+  module->addSection(gtirb::Section::Create(ctx, ".text",
+                                            gtirb::Addr(TextAddress),
+                                            text.size()));
+  module->addSection(gtirb::Section::Create(
+      ctx, ".init_array", gtirb::Addr(InitArrayAddress), zeros.size()));
+  module->addSection(
+      gtirb::Section::Create(ctx, ".data", gtirb::Addr(DataAddress), 8));
+
+  gtirb::Block* frameDummy =
+      gtirb::emplaceBlock(module->getCFG(), ctx, gtirb::Addr(TextAddress),
+                          FrameDummy.size());
+  gtirb::Block* main = gtirb::emplaceBlock(
+      module->getCFG(), ctx, gtirb::Addr(MainAddress), Main.size());
+  module->addData(
+      gtirb::DataObject::Create(ctx, gtirb::Addr(InitArrayAddress), 8));
+  module->addData(
+      gtirb::DataObject::Create(ctx, gtirb::Addr(InitArrayAddress + 8), 8));
+  module->addData(gtirb::DataObject::Create(ctx, gtirb::Addr(DataAddress), 8));
+
+  auto* frameDummySymbol = gtirb::Symbol::Create(
+      ctx, gtirb::Addr(TextAddress), "frame_dummy",
+      gtirb::Symbol::StorageKind::Local);
+  auto* mainSymbol =
+      gtirb::Symbol::Create(ctx, gtirb::Addr(MainAddress), "main",
+                            gtirb::Symbol::StorageKind::Normal);
+  module->addSymbol(frameDummySymbol);
+  module->addSymbol(mainSymbol);
+
+  gtirb::UUID frameDummyId = frameDummySymbol->getUUID();
+  gtirb::UUID mainId = mainSymbol->getUUID();
+  module->addAuxData(
+      "functionEntries",
+      FunctionTable{{frameDummyId, {frameDummy->getUUID()}},
+                    {mainId, {main->getUUID()}}});
+  module->addAuxData(
+      "functionBlocks",
+      FunctionTable{{frameDummyId, {frameDummy->getUUID()}},
+                    {mainId, {main->getUUID()}}});
+
+  module->addSymbolicExpression<gtirb::SymAddrConst>(
+      gtirb::Addr(MainAddress + 1), 0, frameDummySymbol);
+  module->addSymbolicExpression<gtirb::SymAddrConst>(
+      gtirb::Addr(InitArrayAddress), 0, frameDummySymbol);
+  module->addSymbolicExpression<gtirb::SymAddrConst>(
+      gtirb::Addr(InitArrayAddress + 8), 0, mainSymbol);
+  module->addSymbolicExpression<gtirb::SymAddrConst>(gtirb::Addr(DataAddress),
+                                                     0, frameDummySymbol);
+  return module;
+}
+
+size_t failures = 0;
+
+void expect(bool condition, const std::string& message) {
+  if (!condition) {
+    std::cerr << message << '\n';
+    ++failures;
+  }
+}
+
+// frame_dummy is skipped, so its name must not appear: the .init_array
+// entry is dropped and the other references print its address.
+void expectSkipped(const std::string& output, const std::string& what) {
+  expect(output.find("frame_dummy") == std::string::npos,
+         what + " refers to the skipped frame_dummy");
+}
+
+} // namespace
+
+int main() {
+  gtirb::Context ctx;
+  gtirb::Module& module = *buildModule(ctx);
+  gtirb_pprint::PrettyPrinter pp;
+
+  std::ostringstream full;
+  expect(!pp.print(full, ctx, module), "the module could not be printed");
+  expectSkipped(full.str(), "the full print");
+  expect(full.str().find("main") != std::string::npos,
+         "the full print lacks main");
+
+  std::ostringstream streamed;
+  expect(!pp.printStreaming(streamed, ctx, module),
+         "the module could not be streamed");
+  expect(streamed.str() == full.str(),
+         "the streamed output differs from the full print");
+
+  std::string chunks;
+  gtirb_pprint::ChunkGenerator generator = pp.generate(ctx, module);
+  while (std::optional<gtirb_pprint::AssemblyChunk> chunk = generator.next())
+    chunks += chunk->text;
+  expect(chunks == full.str(),
+         "the generated chunks differ from the full print");
+
+  std::ostringstream range;
+  gtirb_pprint::PreparedModule dataSections(
+      ctx, module, gtirb::Addr(InitArrayAddress), gtirb::Addr(DataAddress + 8));
+  expect(!pp.printRange(range, dataSections, gtirb::Addr(InitArrayAddress),
+                        gtirb::Addr(DataAddress + 8)),
+         "the data sections could not be printed");
+  expectSkipped(range.str(), "the data sections");
+  expect(range.str().find("main") != std::string::npos,
+         "the data sections lack the .init_array entry of main");
+
+  std::ostringstream function;
+  gtirb_pprint::PreparedModule mainFunction(
+      ctx, module, gtirb_pprint::PreparedModule::findFunctions(ctx, module,
+                                                               "main"));
+  expect(!pp.printFunction(function, mainFunction, "main"),
+         "main could not be printed");
+  expectSkipped(function.str(), "main");
+
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -1,3 +1,5 @@
+import json
+import os
 import unittest
 from pathlib import Path
 import subprocess
@@ -17,10 +19,252 @@ class TestPrintToStdout(unittest.TestCase):
         self.assertFalse('.globl main' in output)
     
 
+class TestLoadFailure(unittest.TestCase):
+    def test_invalid_ir(self):
+        with open('/tmp/invalid.gtirb', 'w') as f:
+            f.write('not an IR\n')
+        for command in [['--ir', '/tmp/invalid.gtirb'],
+                        ['--diff', '/tmp/invalid.gtirb', str(two_modules_gtirb)]]:
+            proc = subprocess.run(['gtirb-pprinter'] + command,
+                                  stdout=subprocess.PIPE)
+            self.assertEqual(proc.returncode, 1)
+            self.assertTrue('Could not load IR' in
+                            proc.stdout.decode(sys.stdout.encoding))
+
 class TestPrintToFile(unittest.TestCase):
       def test_print_two_modules(self): 
         subprocess.check_output(['gtirb-pprinter','--ir',str(two_modules_gtirb),'--asm','/tmp/two_modules.s']).decode(sys.stdout.encoding)
         with open('/tmp/two_modules.s','r') as f:
             self.assertTrue('.globl main' in f.read())
         with open('/tmp/two_modules1.s','r') as f:
-            self.assertTrue('.globl fun' in f.read())
\ No newline at end of file
+            self.assertTrue('.globl fun' in f.read())
+
+class TestCompact(unittest.TestCase):
+    def test_compact_assembles_identically(self):
+        objects = []
+        for name, flags in [('readable', []), ('compact', ['--compact'])]:
+            subprocess.check_output(['gtirb-pprinter', '--ir', str(two_modules_gtirb),
+                                     '-m', '0', '--asm', '/tmp/{}.s'.format(name)]
+                                    + flags)
+            subprocess.check_call(['as', '/tmp/{}.s'.format(name),
+                                   '-o', '/tmp/{}.o'.format(name)])
+            with open('/tmp/{}.o'.format(name), 'rb') as f:
+                objects.append(f.read())
+        self.assertEqual(objects[0], objects[1])
+        self.assertLess(os.path.getsize('/tmp/compact.s'),
+                        os.path.getsize('/tmp/readable.s'))
+        with open('/tmp/compact.s', 'r') as f:
+            self.assertFalse('===' in f.read())
+
+class TestBatch(unittest.TestCase):
+    def test_print_batch(self):
+        with open('/tmp/batch.txt', 'w') as f:
+            f.write('# input output\n')
+            f.write('{} /tmp/batch_a.s\n'.format(two_modules_gtirb))
+            f.write('\n')
+            f.write('{} /tmp/batch_b.s\n'.format(two_modules_gtirb))
+        output = subprocess.check_output(
+            ['gtirb-pprinter', '--batch', '/tmp/batch.txt', '--jobs', '2']
+        ).decode(sys.stdout.encoding)
+        self.assertTrue('2 of 2 files printed' in output)
+        for name in ['/tmp/batch_a.s', '/tmp/batch_b.s']:
+            with open(name, 'r') as f:
+                self.assertTrue('.globl main' in f.read())
+        with open('/tmp/batch_b1.s', 'r') as f:
+            self.assertTrue('.globl fun' in f.read())
+
+    def test_print_batch_without_extension(self):
+        with open('/tmp/batch_noext.txt', 'w') as f:
+            f.write('{} /tmp/batch_noext\n'.format(two_modules_gtirb))
+        subprocess.check_output(['gtirb-pprinter', '--batch', '/tmp/batch_noext.txt'])
+        with open('/tmp/batch_noext1', 'r') as f:
+            self.assertTrue('.globl fun' in f.read())
+
+    def test_print_batch_failure(self):
+        with open('/tmp/batch_fail.txt', 'w') as f:
+            f.write('{} /tmp/batch_c.s\n'.format(two_modules_gtirb))
+            f.write('/tmp/missing.gtirb /tmp/batch_d.s\n')
+        proc = subprocess.run(
+            ['gtirb-pprinter', '--batch', '/tmp/batch_fail.txt'],
+            stdout=subprocess.PIPE)
+        output = proc.stdout.decode(sys.stdout.encoding)
+        self.assertNotEqual(proc.returncode, 0)
+        self.assertTrue('1 of 2 files printed' in output)
+        self.assertTrue('FAIL' in output)
+
+
+class TestStreaming(unittest.TestCase):
+    def test_streaming_matches_print(self):
+        for module in ['0', '1']:
+            def pprint(*args):
+                return subprocess.check_output(
+                    ['gtirb-pprinter', '--ir', str(two_modules_gtirb),
+                     '-m', module] + list(args)).decode(sys.stdout.encoding)
+            expected = pprint()
+            self.assertEqual(pprint('--streaming'), expected)
+            self.assertEqual(pprint('--streaming', '64'), expected)
+
+class TestSkip(unittest.TestCase):
+    def test_skipped_function_in_every_printing_loop(self):
+        def pprint(*args):
+            return subprocess.check_output(
+                ['gtirb-pprinter', '--ir', str(two_modules_gtirb), '-m', '1',
+                 '--skip-functions', 'fun'] + list(args)).decode(sys.stdout.encoding)
+        expected = pprint()
+        self.assertFalse('.globl fun' in expected)
+        self.assertEqual(pprint('--streaming'), expected)
+        self.assertEqual(pprint('--from', '0'), expected)
+        self.assertEqual(pprint('--range', '0:0xffffffffffffffff'), expected)
+
+class TestDiff(unittest.TestCase):
+    def test_diff_identical_irs(self):
+        output = subprocess.check_output(
+            ['gtirb-pprinter', '--diff', str(two_modules_gtirb),
+             str(two_modules_gtirb)]).decode(sys.stdout.encoding)
+        self.assertTrue(output.startswith('--- '))
+        self.assertFalse('@@' in output)
+        self.assertTrue('0 changed, 0 added, 0 removed' in output)
+
+    def test_diff_needs_two_irs(self):
+        proc = subprocess.run(
+            ['gtirb-pprinter', '--diff', str(two_modules_gtirb)],
+            stdout=subprocess.PIPE)
+        self.assertNotEqual(proc.returncode, 0)
+
+class TestTrace(unittest.TestCase):
+    def test_trace_events(self):
+        subprocess.check_output(['gtirb-pprinter', '--ir', str(two_modules_gtirb),
+                                 '--asm', '/tmp/traced.s',
+                                 '--trace', '/tmp/pprinter_trace.json'])
+        with open('/tmp/pprinter_trace.json', 'r') as f:
+            events = json.load(f)['traceEvents']
+        names = [event['name'] for event in events]
+        self.assertIn('load IR', names)
+        self.assertEqual(names.count('print module'), 2)
+        for event in events:
+            self.assertEqual(event['ph'], 'X')
+            self.assertGreaterEqual(event['dur'], 0)
+            self.assertIn('tid', event)
+
+class TestOutputs(unittest.TestCase):
+    def test_outputs_match_single_prints(self):
+        outputs = [('elf:att::/tmp/output_att.s', ['-s', 'att']),
+                   (':intel:compact:/tmp/output_intel.s',
+                    ['-s', 'intel', '--compact']),
+                   ('::debug,skip=main:/tmp/output_debug.s',
+                    ['-d', '--skip-functions', 'main'])]
+        command = ['gtirb-pprinter', '--ir', str(two_modules_gtirb)]
+        for spec, _ in outputs:
+            command += ['--output', spec]
+        subprocess.check_output(command)
+        for spec, flags in outputs:
+            path = spec.split(':', 3)[3]
+            subprocess.check_output(['gtirb-pprinter', '--ir', str(two_modules_gtirb),
+                                     '--asm', '/tmp/single.s'] + flags)
+            for suffix in ['', '1']:
+                with open('/tmp/single{}.s'.format(suffix), 'r') as f:
+                    expected = f.read()
+                with open(path.replace('.s', '{}.s'.format(suffix)), 'r') as f:
+                    self.assertEqual(f.read(), expected)
+
+    def test_output_without_extension(self):
+        subprocess.check_output(['gtirb-pprinter', '--ir', str(two_modules_gtirb),
+                                 '--output', 'elf:att::/tmp/output_noext'])
+        subprocess.check_output(['gtirb-pprinter', '--ir', str(two_modules_gtirb),
+                                 '--asm', '/tmp/single.s'])
+        for suffix in ['', '1']:
+            with open('/tmp/single{}.s'.format(suffix), 'r') as f:
+                expected = f.read()
+            with open('/tmp/output_noext{}'.format(suffix), 'r') as f:
+                self.assertEqual(f.read(), expected)
+
+    def test_invalid_output(self):
+        proc = subprocess.run(
+            ['gtirb-pprinter', '--ir', str(two_modules_gtirb),
+             '--output', 'elf:att:/tmp/missing_flags.s'], stdout=subprocess.PIPE)
+        self.assertNotEqual(proc.returncode, 0)
+
+class TestListings(unittest.TestCase):
+    def test_listings_match_single_prints(self):
+        subprocess.check_output(['gtirb-pprinter', '--ir', str(two_modules_gtirb),
+                                 '--listing', 'att=/tmp/listing_att.s',
+                                 'intel=/tmp/listing_intel.s'])
+        for syntax in ['att', 'intel']:
+            subprocess.check_output(['gtirb-pprinter', '--ir', str(two_modules_gtirb),
+                                     '-s', syntax,
+                                     '--asm', '/tmp/single_{}.s'.format(syntax)])
+            for suffix in ['', '1']:
+                with open('/tmp/single_{}{}.s'.format(syntax, suffix), 'r') as f:
+                    expected = f.read()
+                with open('/tmp/listing_{}{}.s'.format(syntax, suffix), 'r') as f:
+                    self.assertEqual(f.read(), expected)
+
+
+def fnv1a(data):
+    h = 0xcbf29ce484222325
+    for byte in data:
+        h = ((h ^ byte) * 0x100000001b3) & 0xffffffffffffffff
+    return h
+
+
+class TestIndex(unittest.TestCase):
+    def test_index_ranges(self):
+        subprocess.check_output(['gtirb-pprinter', '--ir', str(two_modules_gtirb),
+                                 '--asm', '/tmp/plain.s'])
+        subprocess.check_output(['gtirb-pprinter', '--ir', str(two_modules_gtirb),
+                                 '--asm', '/tmp/indexed.s',
+                                 '--index', '/tmp/indexed.idx'])
+        with open('/tmp/plain.s', 'rb') as f:
+            expected = f.read()
+        with open('/tmp/indexed.s', 'rb') as f:
+            output = f.read()
+        self.assertEqual(output, expected)
+        with open('/tmp/indexed.idx', 'r') as f:
+            entries = [line.split() for line in f]
+        functions = [e for e in entries if e[0] == 'function']
+        self.assertTrue(any(e[1] == 'main' for e in functions))
+        for entry in functions:
+            begin, end = int(entry[3]), int(entry[4])
+            self.assertTrue((entry[1] + ':').encode() in output[begin:end])
+        for entry in entries:
+            if entry[0] == 'section':
+                begin, end = int(entry[3]), int(entry[4])
+                self.assertEqual(int(entry[5], 16), fnv1a(output[begin:end]))
+            if entry[0] == 'block':
+                self.assertTrue(0 <= int(entry[2]) < int(entry[3]) <= len(output))
+
+
+class TestPrintSelection(unittest.TestCase):
+    def test_print_function(self):
+        output = subprocess.check_output(
+            ['gtirb-pprinter', '--ir', str(two_modules_gtirb), '-m', '1',
+             '--function', 'fun']).decode(sys.stdout.encoding)
+        self.assertTrue('.globl fun' in output)
+        self.assertTrue('.text' in output or '.section' in output)
+        self.assertFalse('.globl main' in output)
+
+    def test_print_missing_function(self):
+        proc = subprocess.run(
+            ['gtirb-pprinter', '--ir', str(two_modules_gtirb),
+             '--function', 'no_such_function'], stdout=subprocess.PIPE)
+        self.assertNotEqual(proc.returncode, 0)
+
+    def test_print_range(self):
+        output = subprocess.check_output(
+            ['gtirb-pprinter', '--ir', str(two_modules_gtirb),
+             '--range', '0:0xffffffffffffffff']).decode(sys.stdout.encoding)
+        self.assertTrue('.globl main' in output)
+        output = subprocess.check_output(
+            ['gtirb-pprinter', '--ir', str(two_modules_gtirb),
+             '--range', '0:0']).decode(sys.stdout.encoding)
+        self.assertFalse('.globl main' in output)
+
+    def test_print_from(self):
+        def pprint(*args):
+            return subprocess.check_output(
+                ['gtirb-pprinter', '--ir', str(two_modules_gtirb)] +
+                list(args)).decode(sys.stdout.encoding)
+        expected = pprint()
+        self.assertEqual(pprint('--from', '0'), expected)
+        self.assertEqual(pprint('--range', '0:0xffffffffffffffff'), expected)
+        self.assertFalse('.globl main' in pprint('--from', '0xffffffffffffffff'))
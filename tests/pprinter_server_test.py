@@ -0,0 +1,125 @@
+import os
+import signal
+import socket
+import subprocess
+import time
+import unittest
+from concurrent.futures import ThreadPoolExecutor
+from pathlib import Path
+
+two_modules_gtirb=Path('tests','two_modules.gtirb')
+socket_path='/tmp/gtirb-pprinter-test.sock'
+
+
+def request(sock,**fields):
+    lines=[]
+    for key,value in fields.items():
+        values=value if isinstance(value,list) else [value]
+        lines+=['{}={}'.format(key.replace('_','-'),v) for v in values]
+    sock.sendall(('\n'.join(lines)+'\n\n').encode())
+    reader=sock.makefile('rb')
+    status=reader.readline().decode().rstrip('\n')
+    if status.startswith('OK '):
+        return status,reader.read(int(status[3:])).decode()
+    return status,''
+
+
+class TestPrintServer(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls):
+        cls.server=subprocess.Popen(['gtirb-pprinter','--serve',socket_path,'--threads','4'],
+                                    stdout=subprocess.DEVNULL)
+        for _ in range(100):
+            if os.path.exists(socket_path):
+                break
+            time.sleep(0.1)
+
+    @classmethod
+    def tearDownClass(cls):
+        cls.server.terminate()
+        cls.server.wait()
+
+    def connect(self):
+        sock=socket.socket(socket.AF_UNIX,socket.SOCK_STREAM)
+        sock.connect(socket_path)
+        return sock
+
+    def test_print_modules(self):
+        with self.connect() as sock:
+            status,output=request(sock,ir=str(two_modules_gtirb),module=0)
+            self.assertTrue(status.startswith('OK'))
+            self.assertTrue('.globl main' in output)
+            status,output=request(sock,ir=str(two_modules_gtirb),module=1)
+            self.assertTrue('.globl fun' in output)
+            self.assertFalse('.globl main' in output)
+
+    def test_skip_function(self):
+        with self.connect() as sock:
+            status,output=request(sock,ir=str(two_modules_gtirb),module=0,skip_function='main')
+            self.assertTrue(status.startswith('OK'))
+            self.assertFalse('.globl main' in output)
+
+    def test_errors(self):
+        with self.connect() as sock:
+            status,_=request(sock,ir=str(two_modules_gtirb),module=5)
+            self.assertTrue(status.startswith('ERROR'))
+            status,_=request(sock,ir='/nonexistent.gtirb')
+            self.assertTrue(status.startswith('ERROR'))
+
+    def test_concurrent_requests(self):
+        def print_module(module):
+            with self.connect() as sock:
+                return request(sock,ir=str(two_modules_gtirb),module=module)[1]
+        with ThreadPoolExecutor(max_workers=4) as pool:
+            outputs=list(pool.map(print_module,[0,1]*4))
+        for i,output in enumerate(outputs):
+            self.assertTrue(('.globl main' if i%2==0 else '.globl fun') in output)
+
+    def test_concurrent_syntaxes(self):
+        def print_syntax(syntax):
+            with self.connect() as sock:
+                return request(sock,ir=str(two_modules_gtirb),module=0,syntax=syntax)[1]
+        expected={syntax:print_syntax(syntax) for syntax in ['att','intel']}
+        with ThreadPoolExecutor(max_workers=4) as pool:
+            syntaxes=['att','intel']*4
+            outputs=list(pool.map(print_syntax,syntaxes))
+        for syntax,output in zip(syntaxes,outputs):
+            self.assertEqual(output,expected[syntax])
+
+    def test_idle_connections(self):
+        # More idle connections than threads must not keep other clients
+        # waiting.
+        idle=[self.connect() for _ in range(8)]
+        try:
+            with self.connect() as sock:
+                sock.settimeout(60)
+                status,output=request(sock,ir=str(two_modules_gtirb),module=0)
+                self.assertTrue(status.startswith('OK'))
+                self.assertTrue('.globl main' in output)
+        finally:
+            for sock in idle:
+                sock.close()
+
+    def test_output_rejected(self):
+        output_path='/tmp/gtirb-pprinter-test-output.S'
+        with self.connect() as sock:
+            status,_=request(sock,ir=str(two_modules_gtirb),output=output_path)
+            self.assertTrue(status.startswith('ERROR'))
+        self.assertFalse(os.path.exists(output_path))
+
+
+class TestPrintServerShutdown(unittest.TestCase):
+    def test_terminate(self):
+        path='/tmp/gtirb-pprinter-shutdown-test.sock'
+        server=subprocess.Popen(['gtirb-pprinter','--serve',path],
+                                stdout=subprocess.DEVNULL)
+        for _ in range(100):
+            if os.path.exists(path):
+                break
+            time.sleep(0.1)
+        idle=socket.socket(socket.AF_UNIX,socket.SOCK_STREAM)
+        idle.connect(path)
+        server.send_signal(signal.SIGTERM)
+        self.assertEqual(server.wait(timeout=60),0)
+        self.assertFalse(os.path.exists(path))
+        idle.close()
@@ -0,0 +1,109 @@
+//===- printer_dispatch_test.cpp --------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2019 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+//
+// Checks that the built-in printers, which print operands without virtual
+// calls, print the same assembly as the same printers called virtually, both
+// one syntax at a time and all syntaxes at once, and that printing all
+// syntaxes at once prints the same assembly as printing them one at a time.
+//
+//===----------------------------------------------------------------------===//
+#include "AttPrettyPrinter.hpp"
+#include "IntelPrettyPrinter.hpp"
+#include "StaticPrettyPrinter.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using gtirb_pprint::AttPrettyPrinter;
+using gtirb_pprint::ElfSyntax;
+using gtirb_pprint::IntelPrettyPrinter;
+using gtirb_pprint::IntelSyntax;
+using gtirb_pprint::StaticPrettyPrinter;
+
+const ElfSyntax attSyntax{};
+const IntelSyntax intelSyntax{};
+
+// Print a module in AT&T and Intel syntax, with one printer per syntax or
+// with both at once.
+template <class Att, class Intel>
+std::vector<std::string> print(const gtirb_pprint::PreparedModule& prepared,
+                               bool together) {
+  const gtirb_pprint::PrintingPolicy& policy =
+      gtirb_pprint::ElfPrettyPrinter::defaultPrintingPolicy();
+  Att att(prepared, attSyntax, policy);
+  Intel intel(prepared, intelSyntax, policy);
+  std::ostringstream attText, intelText;
+  if (together) {
+    gtirb_pprint::PrettyPrinterBase::printAll(
+        {{&att, &attText}, {&intel, &intelText}});
+  } else {
+    att.print(attText);
+    intel.print(intelText);
+  }
+  return {attText.str(), intelText.str()};
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  if (argc != 2) {
+    std::cerr << "usage: " << argv[0] << " IR\n";
+    return EXIT_FAILURE;
+  }
+  gtirb::Context ctx;
+  std::ifstream in(argv[1], std::ios::in | std::ios::binary);
+  gtirb::IR* ir = gtirb::IR::load(ctx, in);
+  if (!ir || ir->modules().empty()) {
+    std::cerr << "could not load " << argv[1] << '\n';
+    return EXIT_FAILURE;
+  }
+
+  size_t failures = 0;
+  for (gtirb::Module& module : ir->modules()) {
+    gtirb_pprint::PreparedModule prepared(ctx, module);
+    std::vector<std::string> separate;
+    for (bool together : {false, true}) {
+      std::vector<std::string> expected =
+          print<AttPrettyPrinter, IntelPrettyPrinter>(prepared, together);
+      std::vector<std::string> actual =
+          print<StaticPrettyPrinter<AttPrettyPrinter>,
+                StaticPrettyPrinter<IntelPrettyPrinter>>(prepared, together);
+      for (size_t i = 0; i < expected.size(); ++i) {
+        if (expected[i].empty() || actual[i] != expected[i]) {
+          ++failures;
+          std::cerr << "module " << module.getName() << ", "
+                    << (i == 0 ? "att" : "intel")
+                    << (together ? " printed with intel and att" : "")
+                    << ": the static printer's output differs\n";
+        }
+        if (together && actual[i] != separate[i]) {
+          ++failures;
+          std::cerr << "module " << module.getName() << ", "
+                    << (i == 0 ? "att" : "intel")
+                    << ": the output printed with intel and att differs\n";
+        }
+      }
+      if (!together)
+        separate = actual;
+    }
+  }
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,49 @@
+import unittest
+from concurrent.futures import ThreadPoolExecutor
+from pathlib import Path
+import subprocess
+
+try:
+    import gtirb_pprinter
+except ImportError:
+    gtirb_pprinter = None
+
+two_modules_gtirb=Path('tests','two_modules.gtirb')
+
+@unittest.skipIf(gtirb_pprinter is None, 'the Python module is not built')
+class TestPythonBinding(unittest.TestCase):
+    def pprint(self, *args):
+        return subprocess.check_output(
+            ['gtirb-pprinter', '--ir', str(two_modules_gtirb)] +
+            list(args))
+
+    def test_print_matches_driver(self):
+        ir = gtirb_pprinter.IR(str(two_modules_gtirb))
+        self.assertEqual(ir.module_count, 2)
+        for module in [0, 1]:
+            assembly = ir.print(module=module)
+            self.assertEqual(bytes(assembly), self.pprint('-m', str(module)))
+            self.assertEqual(len(memoryview(assembly)), len(assembly))
+        self.assertEqual(bytes(ir.print(syntax='intel', compact=True)),
+                         self.pprint('-s', 'intel', '--compact'))
+        self.assertEqual(bytes(ir.print(module=1, function='fun')),
+                         self.pprint('-m', '1', '--function', 'fun'))
+
+    def test_print_from_threads(self):
+        ir = gtirb_pprinter.IR(str(two_modules_gtirb))
+        expected = [bytes(ir.print(module=module)) for module in [0, 1]]
+        with ThreadPoolExecutor(max_workers=4) as pool:
+            printed = list(pool.map(lambda m: bytes(ir.print(module=m)),
+                                    [0, 1] * 4))
+        self.assertEqual(printed, expected * 4)
+
+    def test_errors(self):
+        ir = gtirb_pprinter.IR(str(two_modules_gtirb))
+        with self.assertRaises(IndexError):
+            ir.print(module=2)
+        with self.assertRaises(ValueError):
+            ir.print(function='no_such_function')
+        with self.assertRaises(ValueError):
+            ir.print(syntax='no_such_syntax')
+        with self.assertRaises(ValueError):
+            gtirb_pprinter.IR('no_such_file.gtirb')